@@ -0,0 +1,82 @@
+/*
+ *   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+ *
+ *   Lead Developers: Dan Lovell and Jay Baxter
+ *   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+ *   Research Leads: Vikash Mansinghka, Patrick Shafto
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#ifndef GUARD_chainensemble_h
+#define GUARD_chainensemble_h
+
+#include <string>
+#include <vector>
+#include "DataStore.h"
+#include "Matrix.h"
+#include "State.h"
+#include "ThreadPool.h"
+#include "utils.h"
+#include "constants.h"
+
+/**
+ * Several independent chains (States) over one data set.  The data is
+ * held once, as a single DataStore that every chain is built on and
+ * reads, so adding a chain only costs its latent state.  As for any
+ * DataStore, a column-major view passed in is borrowed and must outlive
+ * the ensemble; other data is copied once.  The chains are transitioned
+ * in parallel on a ThreadPool.
+ */
+class ChainEnsemble
+{
+public:
+    /** Draw one State from the prior per element of SEEDS.  The other
+     *  arguments are as for State's prior constructor.
+     */
+    ChainEnsemble(const MatrixD &data,
+        const std::vector<std::string> &GLOBAL_COL_DATATYPES,
+        const std::vector<int> &GLOBAL_COL_MULTINOMIAL_COUNTS,
+        const std::vector<int> &global_row_indices,
+        const std::vector<int> &global_col_indices,
+        const std::vector<int> &SEEDS,
+        const std::string &col_initialization = FROM_THE_PRIOR,
+        std::string row_initialization = "",
+        int N_GRID = 31, int CT_KERNEL = 0);
+    ~ChainEnsemble();
+    //
+    // getters
+    int get_num_chains() const;
+    int get_num_threads() const;
+    State &get_chain(int chain_idx);
+    //
+    // mutators
+    /**
+     * Transition chains on num_threads threads.  Each chain draws from its
+     * own rng, so the chains don't depend on num_threads.
+     */
+    void set_num_threads(int num_threads);
+    /**
+     * Run n_steps of State::transition(data) on every chain, where data
+     * is the matrix the ensemble was built from
+     * \return The score delta of each chain
+     */
+    std::vector<double> transition(const MatrixD &data, int n_steps);
+private:
+    DISALLOW_COPY_AND_ASSIGN(ChainEnsemble);
+    DataStore data_store;
+    std::vector<State *> chains;
+    // NULL unless set_num_threads was given more than one thread
+    ThreadPool *p_thread_pool;
+};
+
+#endif // GUARD_chainensemble_h
@@ -49,8 +49,6 @@ public:
     double get_marginal_logp() const;
     std::map<std::string, double> get_suffstats_i(int idx) const;
     CM_Hypers get_hypers_i(int idx) const;
-    std::set<int> get_row_indices_set() const;
-    std::vector<int> get_row_indices_vector() const;
     std::vector<double> get_draw(int random_seed) const;
     //
     // calculators
@@ -60,21 +58,49 @@ public:
     std::vector<double> calc_hyper_conditionals(int which_col,
         const std::string &which_hyper,
         const std::vector<double> &hyper_grid) const;
+    std::vector<double> calc_hyper_conditionals(int which_col,
+        HyperId which_hyper,
+        const std::vector<double> &hyper_grid) const;
+    /**
+     * row_indices are this cluster's rows, which index column_data
+     */
     double calc_column_predictive_logp(const std::vector<double> &column_data,
         const std::string &col_datatype,
-        const std::vector<int> &data_global_row_indices,
+        const std::vector<int> &row_indices,
         const CM_Hypers &hypers);
     //
     // mutators
+    // which rows are in the cluster is tracked by the owning View; the
+    // cluster only counts them
     double insert_row(const std::vector<double> &values, int row_idx);
     double remove_row(const std::vector<double> &values, int row_idx);
+    /**
+     * Remove column col_idx, moving the last column into its place
+     */
     double remove_col(int col_idx);
+    /**
+     * row_indices are this cluster's rows, which index data
+     */
     double insert_col(const std::vector<double> &data,
         const std::string &col_datatype,
-        const std::vector<int> &data_global_row_indices,
+        const std::vector<int> &row_indices,
         const CM_Hypers &hypers);
+    /**
+     * As insert_col, from the column's suffstats rather than its data.
+     * suffstats points at the count, then sum_x and sum_x_squared,
+     * sum_sin_x and sum_cos_x or the K label counts, as
+     * State::save_snapshot writes them
+     */
+    double insert_col_suffstats(const double *suffstats,
+        const std::string &col_datatype, const CM_Hypers &hypers);
     double incorporate_hyper_update(int which_col);
+    double incorporate_hyper_update(int which_col, HyperId which_hyper,
+        double value);
     void delete_component_models(bool check_empty = true);
+    /**
+     * Reset an empty cluster's component models for reuse
+     */
+    void reset();
     //
     // helpers
     friend std::ostream &operator<<(std::ostream &os, const Cluster &c);
@@ -86,7 +112,7 @@ public:
 private:
     double score;
     void init_columns(const std::vector<CM_Hypers *> &hypers_v);
-    std::set<int> row_indices;
+    int count;
 };
 
 #endif // GUARD_cluster_h
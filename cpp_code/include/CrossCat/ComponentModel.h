@@ -29,6 +29,7 @@
 #include <vector>
 #include "utils.h"
 #include "constants.h"
+#include "Hypers.h"
 
 class ComponentModel
 {
@@ -50,14 +51,28 @@ public:
     virtual double calc_element_predictive_logp(double element) const = 0;
     virtual double calc_element_predictive_logp_constrained(double element,
         const std::vector<double> &constraints) const = 0;
-    virtual std::vector<double> calc_hyper_conditionals(
+    std::vector<double> calc_hyper_conditionals(
         const std::string &which_hyper,
+        const std::vector<double> &hyper_grid) const;
+    virtual std::vector<double> calc_hyper_conditionals(
+        HyperId which_hyper,
         const std::vector<double> &hyper_grid) const = 0;
     //
     // mutators
     virtual double insert_element(double element) = 0;
     virtual double remove_element(double element) = 0;
     virtual double incorporate_hyper_update() = 0;
+    /**
+     * Incorporate a change of one hyper to value, which the owner of the
+     * hypers object has already stored there, without re-reading it
+     */
+    virtual double incorporate_hyper_update(HyperId which_hyper,
+        double value) = 0;
+    /**
+     * Forget all elements and re-read the hypers, leaving the model as if
+     * freshly constructed, so it can be reused for a new cluster
+     */
+    void reset();
     //
     // helpers
     friend std::ostream &operator<<(std::ostream &os, const ComponentModel &cm);
@@ -51,13 +51,15 @@ public:
     double calc_element_predictive_logp(double element) const;
     double calc_element_predictive_logp_constrained(double element,
         const std::vector<double> &constraints) const;
-    std::vector<double> calc_hyper_conditionals(const std::string &which_hyper,
+    using ComponentModel::calc_hyper_conditionals;
+    std::vector<double> calc_hyper_conditionals(HyperId which_hyper,
         const std::vector<double> &hyper_grid) const;
     //
     // mutators
     double insert_element(double element);
     double remove_element(double element);
     double incorporate_hyper_update();
+    double incorporate_hyper_update(HyperId which_hyper, double value);
 
 protected:
     void set_log_Z_0();
@@ -0,0 +1,72 @@
+/*
+ *   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+ *
+ *   Lead Developers: Dan Lovell and Jay Baxter
+ *   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+ *   Research Leads: Vikash Mansinghka, Patrick Shafto
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#ifndef GUARD_datastore_h
+#define GUARD_datastore_h
+
+#include <vector>
+#include "Matrix.h"
+#include "utils.h"
+
+/**
+ * The data being modelled, column by column, shared by a State and all
+ * of its Views.  Each column is contiguous, so a View can read the cells
+ * of its own columns in place instead of materializing a per-view data
+ * subset on every sweep.  Rows may be appended (see State::insert_row)
+ * but existing cells are never modified.
+ *
+ * A column-major view (see matrix::get_column_major_view_data), such as
+ * a Fortran-ordered ndarray wrapped by State.pyx, is borrowed rather
+ * than copied and must outlive the DataStore.  Any other matrix is
+ * copied once.
+ */
+class DataStore
+{
+public:
+    DataStore(const MatrixD &data);
+    //
+    // getters
+    int get_num_rows() const;
+    int get_num_cols() const;
+    double get_value(int row_idx, int col_idx) const;
+    /**
+     * Gather the cells of row_idx in the order given by col_indices
+     * into row_data, which is resized as needed.
+     */
+    void get_row(int row_idx, const std::vector<int> &col_indices,
+        std::vector<double> &row_data) const;
+    std::vector<double> get_column(int col_idx) const;
+    std::vector<std::vector<double> > get_columns(
+        const std::vector<int> &col_indices) const;
+    //
+    // mutators
+    void append_row(const std::vector<double> &row_data);
+private:
+    DISALLOW_COPY_AND_ASSIGN(DataStore);
+    int num_rows;
+    int num_cols;
+    // num_rows x num_cols cells, column by column: the borrowed buffer or
+    // owned_values
+    const double *values;
+    std::vector<double> owned_values;
+    // rows added after construction, row by row
+    std::vector<std::vector<double> > appended_rows;
+};
+
+#endif // GUARD_datastore_h
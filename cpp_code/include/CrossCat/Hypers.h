@@ -0,0 +1,56 @@
+/*
+ *   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+ *
+ *   Lead Developers: Dan Lovell and Jay Baxter
+ *   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+ *   Research Leads: Vikash Mansinghka, Patrick Shafto
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#ifndef GUARD_hypers_h
+#define GUARD_hypers_h
+
+#include <string>
+
+/**
+ * Typed names for the component model hyperparameters.  CM_Hypers, the
+ * string-keyed dictionary, stays the interchange format with State's
+ * callers; inside a transition hypers are addressed by HyperId so that
+ * updates and conditionals don't compare strings per cluster.
+ */
+enum HyperId {
+    // continuous
+    HYPER_R,
+    HYPER_NU,
+    HYPER_S,
+    HYPER_MU,
+    // cyclic
+    HYPER_KAPPA,
+    HYPER_A,
+    HYPER_B,
+    // multinomial
+    HYPER_DIRICHLET_ALPHA,
+    HYPER_K,
+    NUM_HYPER_IDS
+};
+
+/**
+ * The HyperId for a CM_Hypers key; exits on an unknown name
+ */
+HyperId get_hyper_id(const std::string &hyper_name);
+/**
+ * The CM_Hypers key for a HyperId
+ */
+const std::string &get_hyper_name(HyperId hyper_id);
+
+#endif // GUARD_hypers_h
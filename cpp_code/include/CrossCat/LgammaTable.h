@@ -0,0 +1,53 @@
+/*
+ *   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+ *
+ *   Lead Developers: Dan Lovell and Jay Baxter
+ *   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+ *   Research Leads: Vikash Mansinghka, Patrick Shafto
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#ifndef GUARD_lgammatable_h
+#define GUARD_lgammatable_h
+
+#include <map>
+#include <vector>
+
+/**
+ * Memoized lgamma(n + offset) for integer n >= 0 and a handful of
+ * offsets, such as the values of a hyper grid.  The CRP and
+ * Dirichlet-multinomial scores only ever evaluate lgamma at counts
+ * shifted by a grid value, so after the first sweep over a grid they
+ * become table lookups.  Entries are filled on first use and are equal
+ * to calling lgamma directly.  Only n below MAX_TABLE_N is tabulated, so
+ * an offset costs at most MAX_TABLE_N doubles; larger n, such as a
+ * view's row count, call lgamma each time.
+ *
+ * Not thread safe: each table must be used by one thread at a time.
+ */
+class LgammaTable
+{
+public:
+    LgammaTable();
+    /**
+     * lgamma(n + offset)
+     */
+    double lgamma_shifted(int n, double offset);
+    int get_num_offsets() const;
+    void clear();
+    static const int MAX_TABLE_N = 4096;
+private:
+    std::map<double, std::vector<double> > tables;
+};
+
+#endif // GUARD_lgammatable_h
@@ -24,6 +24,11 @@
 #include <limits>
 #include <stdexcept>
 
+/**
+ * A dense nrows x ncols matrix.  It either owns its row-major storage or,
+ * when built from an existing buffer, is a non-owning view of it in row-
+ * or column-major order; copying a view makes an owning matrix.
+ */
 template<typename T>
 class matrix
 {
@@ -36,9 +41,11 @@ public:
     {
         return _ncols;
     }
-    matrix() : _nrows(0), _ncols(0), _data(0) {}
+    matrix() : _nrows(0), _ncols(0), _row_stride(0), _col_stride(1),
+        _data(0), _owns_data(true) {}
     matrix(size_t nrows, size_t ncols)
-        : _nrows(nrows), _ncols(ncols), _data(new T[nrows * ncols])
+        : _nrows(nrows), _ncols(ncols), _row_stride(ncols), _col_stride(1),
+          _data(new T[nrows * ncols]), _owns_data(true)
     {
         if (nrows > std::numeric_limits<size_t>::max() / ncols) {
             T *d = _data;
@@ -49,29 +56,54 @@ public:
             throw std::bad_alloc();
         }
     }
+    /**
+     * View nrows * ncols elements of data, stored column by column if
+     * column_major and row by row otherwise.  data must outlive the view.
+     */
+    matrix(T *data, size_t nrows, size_t ncols, bool column_major)
+        : _nrows(nrows), _ncols(ncols),
+          _row_stride(column_major ? 1 : ncols),
+          _col_stride(column_major ? nrows : 1),
+          _data(data), _owns_data(false) {}
     matrix(const matrix &m)
     {
-        size_t i;
+        size_t i, j;
         _nrows = m._nrows;
         _ncols = m._ncols;
+        _row_stride = _ncols;
+        _col_stride = 1;
         _data = new T[_nrows * _ncols];
-        for (i = 0; i < _nrows * _ncols; i++) {
-            _data[i] = m._data[i];
+        _owns_data = true;
+        for (i = 0; i < _nrows; i++) {
+            for (j = 0; j < _ncols; j++) {
+                _data[i * _ncols + j] = m._data[m.offset(i, j)];
+            }
         }
     }
     matrix &operator=(matrix m)
     {
         std::swap(_nrows, m._nrows);
         std::swap(_ncols, m._ncols);
+        std::swap(_row_stride, m._row_stride);
+        std::swap(_col_stride, m._col_stride);
         std::swap(_data, m._data);
+        std::swap(_owns_data, m._owns_data);
         return *this;
     }
     ~matrix()
     {
-        if (_data) {
+        if (_data && _owns_data) {
             delete[] _data;
         }
     }
+    /**
+     * The buffer of a view stored column by column, else NULL.  Like the
+     * view, it is only valid while the viewed data lives
+     */
+    const T *get_column_major_view_data() const
+    {
+        return !_owns_data && _row_stride == 1 ? _data : 0;
+    }
     T &operator()(size_t row, size_t col)
     {
         if (_nrows <= row) {
@@ -80,7 +112,7 @@ public:
         if (_ncols <= col) {
             throw std::range_error("column out of range");
         }
-        return _data[row * _ncols + col];
+        return _data[offset(row, col)];
     }
     const T &operator()(size_t row, size_t col) const
     {
@@ -90,12 +122,19 @@ public:
         if (_ncols <= col) {
             throw std::range_error("column out of range");
         }
-        return _data[row * _ncols + col];
+        return _data[offset(row, col)];
     }
 private:
     size_t _nrows;
     size_t _ncols;
+    size_t _row_stride;
+    size_t _col_stride;
     T *_data;
+    bool _owns_data;
+    size_t offset(size_t row, size_t col) const
+    {
+        return row * _row_stride + col * _col_stride;
+    }
 };
 
 typedef matrix<double> MatrixD;
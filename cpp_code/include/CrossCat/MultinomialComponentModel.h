@@ -44,19 +44,23 @@ public:
     double get_draw(int random_seed) const;
     double get_draw_constrained(int random_seed,
         const std::vector<double> &constraints) const;
+    // num_draws independent draws, from an alias table built once
+    std::vector<double> get_draws(int random_seed, int num_draws) const;
     //
     // calculators
     double calc_marginal_logp() const;
     double calc_element_predictive_logp(double element) const;
     double calc_element_predictive_logp_constrained(double element,
         const std::vector<double> &constraints) const;
-    std::vector<double> calc_hyper_conditionals(const std::string &which_hyper,
+    using ComponentModel::calc_hyper_conditionals;
+    std::vector<double> calc_hyper_conditionals(HyperId which_hyper,
         const std::vector<double> &hyper_grid) const;
     //
     // mutators
     double insert_element(double element);
     double remove_element(double element);
     double incorporate_hyper_update();
+    double incorporate_hyper_update(HyperId which_hyper, double value);
 protected:
     void set_log_Z_0();
     void init_suffstats();
@@ -20,7 +20,9 @@
 #ifndef GUARD_randomnumbergenerator_h
 #define GUARD_randomnumbergenerator_h
 
+#include <cstddef>
 #include <ctime>
+#include <string>
 #include <stdint.h>
 
 #include "constants.h"
@@ -34,12 +36,36 @@ public:
         set_seed(seed);
     }
     double next();
+    /**
+     * Bulk samplers for hot paths that consume many variates at once.
+     * They draw keystream a few blocks at a time with
+     * crypto_weakprng_buf, so their values are not those of the scalar
+     * calls.  Uniforms have 53 bits of resolution and lie strictly in
+     * (0, 1), so their logs are finite.
+     */
+    void fill_uniform(double *out, size_t n);
+    void fill_stdnormal(double *out, size_t n);
+    void fill_stdgamma(double *out, size_t n, double alpha);
     int nexti(int bound = MAX_INT);
     double stdnormal();
     double stdgamma(double alpha);
     double chisquare(double nu);
     double student_t(double nu);
     void set_seed(std::time_t seed);
+    /**
+     * An independent generator for stream stream_id.  The result is a
+     * function of this generator's seed and stream_id only -- not of
+     * how many draws have been made -- so per-view, per-column or
+     * per-chain streams can be derived in any order and consumed on
+     * worker threads without changing the results.
+     */
+    RandomNumberGenerator split(uint64_t stream_id) const;
+    /**
+     * The generator's complete state as opaque bytes, which set_state
+     * restores exactly, so a stream can be checkpointed and resumed
+     */
+    std::string get_state() const;
+    void set_state(const std::string &state);
 protected:
     struct crypto_weakprng _weakprng;
 };
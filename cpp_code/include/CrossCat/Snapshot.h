@@ -0,0 +1,98 @@
+/*
+ *   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+ *
+ *   Lead Developers: Dan Lovell and Jay Baxter
+ *   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+ *   Research Leads: Vikash Mansinghka, Patrick Shafto
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#ifndef GUARD_snapshot_h
+#define GUARD_snapshot_h
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "utils.h"
+
+/**
+ * Version of the layout State::save_snapshot writes; bump it whenever
+ * that layout changes
+ */
+const int32_t SNAPSHOT_VERSION = 2;
+
+/**
+ * Binary output for State snapshots.  The file starts with a magic
+ * string, the version and a byte order mark; after that every value is a
+ * fixed-width int32 or double in host byte order, and a vector is its
+ * length followed by its elements, so arrays can be read back (or mapped)
+ * as contiguous runs.  Failing to open or write the file throws
+ * std::runtime_error.
+ */
+class SnapshotWriter
+{
+public:
+    SnapshotWriter(const std::string &filename);
+    // closes the file if close wasn't called, without checking for errors
+    ~SnapshotWriter();
+    void write_int(int32_t value);
+    void write_double(double value);
+    void write_ints(const std::vector<int> &values);
+    void write_doubles(const std::vector<double> &values);
+    void write_string(const std::string &value);
+    /**
+     * Flush and close the file; throws if that fails, so the snapshot
+     * isn't complete until this returns
+     */
+    void close();
+private:
+    DISALLOW_COPY_AND_ASSIGN(SnapshotWriter);
+    std::string filename;
+    std::FILE *fp;
+    void write(const void *data, size_t num_bytes);
+};
+
+/**
+ * Reads what SnapshotWriter wrote.  A missing file, a bad header, a
+ * version other than SNAPSHOT_VERSION, a truncated file or a vector
+ * longer than what is left of the file throws std::runtime_error, so a
+ * corrupt snapshot never triggers a huge allocation.
+ */
+class SnapshotReader
+{
+public:
+    SnapshotReader(const std::string &filename);
+    ~SnapshotReader();
+    int32_t read_int();
+    double read_double();
+    std::vector<int> read_ints();
+    std::vector<double> read_doubles();
+    std::string read_string();
+private:
+    DISALLOW_COPY_AND_ASSIGN(SnapshotReader);
+    std::string filename;
+    std::FILE *fp;
+    // bytes not yet read
+    long num_bytes_left;
+    // sets num_bytes_left and checks the magic string, version and byte
+    // order mark
+    void read_header();
+    // a vector or string length, checked against num_bytes_left for
+    // elements of element_size bytes
+    int32_t read_size(size_t element_size);
+    void read(void *data, size_t num_bytes);
+    void fail(const std::string &reason);
+};
+
+#endif // GUARD_snapshot_h
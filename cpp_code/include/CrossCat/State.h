@@ -23,6 +23,9 @@
 #include <set>
 #include <vector>
 #include "View.h"
+#include "DataStore.h"
+#include "LgammaTable.h"
+#include "ThreadPool.h"
 #include "utils.h"
 #include "constants.h"
 #include <fstream>
@@ -116,6 +119,35 @@ public:
         const std::vector<double> &MU_GRID = empty_vector_double,
         int N_GRID = 31, int SEED = 0, int CT_KERNEL = 0);
 
+    /** As the constructor above, but reading the data from data_store,
+     *  which the State shares rather than copies and which must outlive
+     *  it.  Lets several States over one data set share a single
+     *  DataStore (see ChainEnsemble).  Rows can't be inserted.
+     */
+    State(DataStore &data_store,
+        const std::vector<std::string> &GLOBAL_COL_DATATYPES,
+        const std::vector<int> &GLOBAL_COL_MULTINOMIAL_COUNTS,
+        const std::vector<int> &global_row_indices,
+        const std::vector<int> &global_col_indices,
+        const std::string &col_initialization = FROM_THE_PRIOR,
+        std::string row_initialization = "",
+        const std::vector<double> &ROW_CRP_ALPHA_GRID = empty_vector_double,
+        const std::vector<double> &COLUMN_CRP_ALPHA_GRID = empty_vector_double,
+        const std::vector<double> &S_GRID = empty_vector_double,
+        const std::vector<double> &MU_GRID = empty_vector_double,
+        int N_GRID = 31, int SEED = 0, int CT_KERNEL = 0);
+
+    /** Constructor for a state saved with save_snapshot.
+     *  The clusters are loaded from the saved suffstats, in time
+     *  proportional to the snapshot rather than to the data, and the
+     *  generators resume where the saved state's were.  Throws
+     *  std::runtime_error if the file can't be read, is corrupt or was
+     *  taken on a table of another shape.
+     *  \param data The data the snapshot was taken on
+     *  \param snapshot_filename The file written by save_snapshot
+     */
+    State(const MatrixD &data, const std::string &snapshot_filename);
+
     ~State();
 
     //
@@ -164,6 +196,10 @@ public:
      * \return The column indices in each column partition
      */
     std::map<int, std::vector<int> > get_column_groups() const;
+    /**
+     * \return The number of threads used for per-view transitions
+     */
+    int get_num_threads() const;
     /**
      * \return A uniform random draw from [0, 1] using the state's rng
      */
@@ -214,6 +250,12 @@ public:
      * Each cluster membership is itself a list denoting which cluster a row belongs to
      */
     std::vector<std::vector<int> > get_X_D() const;
+    /**
+     * The state's RandomNumberGenerator state followed by each view's, in
+     * view order.  Restoring them with set_rng_states continues the chain
+     * exactly where it was.
+     */
+    std::vector<std::string> get_rng_states() const;
     /**
      * Draw a sample row based on an existing row
      */
@@ -224,6 +266,21 @@ public:
     //
     // mutators
     //
+    /**
+     * Run per-view transitions (transition_views, transition_views_zs,
+     * transition_row_partition_assignments,
+     * transition_row_partition_subsample,
+     * transition_row_partition_split_merge) on num_threads threads.
+     * Views are conditionally independent given the column partition and
+     * each draws from its own rng, so the chain does not depend on
+     * num_threads.  Defaults to 1, which transitions views serially.
+     */
+    void set_num_threads(int num_threads);
+    /**
+     * Restore generator states from get_rng_states, taken when the state
+     * had the same number of views
+     */
+    void set_rng_states(const std::vector<std::string> &rng_states);
     /**
      * Insert feature_data into the view specified by which_view.  feature_idx
      * is the column index to associate with it
@@ -383,6 +440,20 @@ public:
      */
     double transition_row_partition_assignments(const MatrixD &data,
         std::vector<int> which_rows);
+    /**
+     * Gibbs sample cluster membership of num_rows rows per view, each
+     * view drawing its own subset; see View::transition_zs_subsample
+     * \return The delta in the state's marginal log probability
+     */
+    double transition_row_partition_subsample(const MatrixD &data,
+        int num_rows);
+    /**
+     * num_proposals split-merge proposals on the row partition of every
+     * view; see View::transition_split_merge
+     * \return The delta in the state's marginal log probability
+     */
+    double transition_row_partition_split_merge(const MatrixD &data,
+        int num_proposals);
     //
     // calculators
     /**
@@ -458,6 +529,13 @@ public:
      */
     std::vector<double> calc_column_crp_marginals(const std::vector<double> &
         alphas_to_score) const;
+    /**
+     * Write the latent state -- datatypes, grids, hypers, column and row
+     * partitions, per-cluster suffstats and generator states -- to
+     * filename in the binary
+     * format of SnapshotWriter, to be loaded with the snapshot constructor
+     */
+    void save_snapshot(const std::string &filename) const;
     friend std::ostream &operator<<(std::ostream &os, const State &s);
     std::string to_string(const std::string &join_str = "\n",
         bool top_level = false) const;
@@ -470,6 +548,9 @@ private:
     double column_crp_alpha;
     double column_crp_score;
     double data_score;
+    // sum over views of lgamma(number of columns), kept up to date by
+    // insert_feature and remove_feature for calc_column_crp_marginal(s)
+    double sum_log_gamma_view_counts;
     int ct_kernel;
     // column structure ensure
     std::map<int, std::set<int> > column_dependencies;
@@ -488,18 +569,33 @@ private:
     std::map<int, std::vector<double> > vm_kappa_grids;
     // lookups
     std::vector<View *> views;
-    std::map<int, View *> view_lookup; // global_column_index to View mapping
+    // View of each global column index, NULL while a feature is between
+    // views, and the number of columns that have one
+    std::vector<View *> view_lookup;
+    int num_assigned_cols;
     // sub-objects
     RandomNumberGenerator rng;
+    // the data, read in place by the views: the State's own DataStore, or
+    // NULL for one shared through the DataStore constructor
+    DataStore *p_owned_data_store;
+    DataStore *p_data_store;
+    // NULL unless set_num_threads was given more than one thread
+    ThreadPool *p_thread_pool;
+    // lgamma at view counts shifted by column_crp_alpha_grid values
+    mutable LgammaTable lgamma_table;
+    // cumulative weights for numerics::draw_sample_unnormalized
+    std::vector<double> sample_buffer;
     // resources
     void increment_num_cols_effective();
     void decrement_num_cols_effective();
-    void construct_base_hyper_grids(const matrix<double> &
-        data, int N_GRID,
+    // run task once per view, on p_thread_pool if there is one
+    void run_view_tasks(ThreadPoolTask &task) const;
+    // the grids read the data from p_data_store, as do init_views and
+    // init_from_prior
+    void construct_base_hyper_grids(int N_GRID,
         std::vector<double> ROW_CRP_ALPHA_GRID,
         std::vector<double> COLUMN_CRP_ALPHA_GRID);
-    void construct_column_hyper_grids(const matrix<double> &
-        data,
+    void construct_column_hyper_grids(
         const std::vector<int> &global_col_indices,
         const std::vector<std::string> &global_col_datatypes,
         const std::vector<double> &S_GRID,
@@ -518,12 +614,40 @@ private:
     void init_base_hypers();
     CM_Hypers uniform_sample_hypers(int global_col_idx);
     void init_column_hypers(const std::vector<int> &global_col_indices);
-    void init_views(const MatrixD &data,
+    // the body of the prior constructors
+    void init_from_prior(const std::vector<std::string> &GLOBAL_COL_DATATYPES,
+        const std::vector<int> &GLOBAL_COL_MULTINOMIAL_COUNTS,
         const std::vector<int> &global_row_indices,
+        const std::vector<int> &global_col_indices,
+        const std::string &col_initialization,
+        std::string row_initialization,
+        const std::vector<double> &ROW_CRP_ALPHA_GRID,
+        const std::vector<double> &COLUMN_CRP_ALPHA_GRID,
+        const std::vector<double> &S_GRID,
+        const std::vector<double> &MU_GRID,
+        int N_GRID, int CT_KERNEL);
+    void init_views(const std::vector<int> &global_row_indices,
         const std::vector<int> &global_col_indices,
         const std::vector<std::vector<int> > &column_partition,
         const std::vector<std::vector<std::vector<int> > > &row_partition_v,
-        const std::vector<double> &row_crp_alpha_v);
+        const std::vector<double> &row_crp_alpha_v,
+        const std::vector<std::vector<double> > *p_view_suffstats = NULL);
+    // suffstats of each cluster of v, cluster by cluster and column by
+    // column: count, sum_0, sum_1 or count and the K label counts
+    std::vector<double> get_view_suffstats(View &v) const;
+    // how many of the above a cluster saves for the column: 3 or 1 + K
+    int get_num_saved_suffstats(int global_col_idx) const;
+    // the body of the snapshot constructor
+    void load_snapshot(const std::string &snapshot_filename);
+    void fail_snapshot(const std::string &snapshot_filename,
+        const std::string &reason) const;
+    // insert column_indices into v, whose clusters are already partitioned,
+    // from suffstats in the layout of get_view_suffstats
+    void insert_saved_suffstats(View &v, const std::vector<int> &column_indices,
+        const std::vector<double> &suffstats);
+    // whether v's counts are those of the data, for a debug check of a
+    // loaded snapshot
+    bool view_counts_match_data(View &v) const;
 };
 
 #endif // GUARD_state_h
@@ -0,0 +1,144 @@
+/*
+ *   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+ *
+ *   Lead Developers: Dan Lovell and Jay Baxter
+ *   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+ *   Research Leads: Vikash Mansinghka, Patrick Shafto
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#ifndef GUARD_suffstattable_h
+#define GUARD_suffstattable_h
+
+#include <string>
+#include <vector>
+#include "utils.h"
+#include "LgammaTable.h"
+#include "Hypers.h"
+
+/**
+ * Columnar sufficient statistics for all clusters of a View.  Each local
+ * column keeps one contiguous array per statistic, indexed by cluster
+ * index (the position in View::clusters).  Scoring a row against every
+ * cluster then walks those arrays column by column with the column's
+ * hypers read once, rather than making one virtual ComponentModel call
+ * per column per cluster.
+ *
+ * The table mirrors the clusters' ComponentModels, which remain the
+ * reference for scores, most hyper conditionals and draws; View keeps the
+ * two in step.
+ */
+class SuffstatTable
+{
+public:
+    SuffstatTable();
+    //
+    // getters
+    int get_num_clusters() const;
+    int get_num_cols() const;
+    //
+    // calculators
+    /**
+     * Fill data_logps[k] with the predictive log probability of vd under
+     * cluster k, and data_logps[get_num_clusters()] with that under an
+     * empty cluster.  NaN cells contribute nothing.
+     */
+    void calc_row_predictive_logps(const std::vector<double> &vd,
+        std::vector<double> &data_logps) const;
+    /**
+     * Sum over clusters of numerics::calc_multinomial_dirichlet_alpha_conditional
+     * for multinomial column col_idx, as View::calc_hyper_conditionals
+     * would compute it from the ComponentModels
+     */
+    std::vector<double> calc_dirichlet_alpha_conditionals(int col_idx,
+        const std::vector<double> &dirichlet_alpha_grid,
+        LgammaTable &lgamma_table) const;
+    /**
+     * Sum over clusters of numerics::calc_continuous_{r,nu,s,mu}_conditionals
+     * for continuous column col_idx, computed in one fused pass by
+     * numerics::calc_continuous_hyper_conditionals
+     */
+    std::vector<double> calc_continuous_hyper_conditionals(int col_idx,
+        HyperId which_hyper, const std::vector<double> &hyper_grid) const;
+    //
+    // mutators
+    void insert_cluster();
+    void remove_cluster(int cluster_idx);
+    /**
+     * Append a column with every cluster empty, to be filled with
+     * insert_element
+     */
+    void insert_col(const std::string &col_datatype, const CM_Hypers &hypers);
+    /**
+     * Remove column col_idx, moving the last column into its place
+     */
+    void remove_col(int col_idx);
+    void insert_element(int cluster_idx, int col_idx, double element);
+    /**
+     * Set cluster cluster_idx's suffstats of column col_idx, laid out as
+     * for Cluster::insert_col_suffstats, in place of inserting elements
+     */
+    void set_suffstats(int cluster_idx, int col_idx, const double *suffstats);
+    void insert_row(int cluster_idx, const std::vector<double> &vd);
+    void remove_row(int cluster_idx, const std::vector<double> &vd);
+    /**
+     * Re-read column col_idx's hypers after they changed
+     */
+    void incorporate_hyper_update(int col_idx);
+private:
+    enum Datatype { CONTINUOUS, CYCLIC, MULTINOMIAL };
+    struct Column {
+        Datatype datatype;
+        const CM_Hypers *p_hypers;
+        // continuous: r, nu, s, mu; cyclic: kappa, a, b; multinomial: alpha
+        double hyper_0, hyper_1, hyper_2, hyper_3;
+        // continuous only
+        double log_Z_0;
+        int K;
+        // the hyper-only parts of an empty cluster's predictive logp, set
+        // by read_hypers.  cyclic: a cos b, a sin b, -log(2 pi I0(kappa))
+        // and log I0 of the prior's a; multinomial: the logp of any label
+        double empty_0, empty_1, empty_2, empty_3;
+        // per cluster
+        std::vector<int> count;
+        // continuous: sum_x, sum_x_squared; cyclic: sum_sin_x, sum_cos_x
+        std::vector<double> sum_0;
+        std::vector<double> sum_1;
+        // continuous only: the marginal logp of each cluster, as tracked by
+        // ContinuousComponentModel::score
+        std::vector<double> score;
+        // multinomial only: K label counts per cluster
+        std::vector<int> label_counts;
+        // continuous only: numerics::calc_continuous_predictive_terms per
+        // cluster, plus a trailing slot for an empty cluster
+        std::vector<double> pred_mu;
+        std::vector<double> pred_s;
+        std::vector<double> pred_weight;
+        std::vector<double> pred_half_nu;
+        std::vector<double> pred_base;
+        // exchange contents without copying the per cluster vectors
+        void swap(Column &other);
+    };
+    int num_clusters;
+    std::vector<Column> columns;
+    void read_hypers(Column &column);
+    // also refreshes the cluster's predictive terms
+    void refresh_score(Column &column, int cluster_idx);
+    // cluster_idx == num_clusters for the empty slot
+    void refresh_predictive_terms(Column &column, int cluster_idx);
+    // false if element is NaN and so not counted
+    bool update_element(Column &column, int cluster_idx, double element,
+        int sign);
+};
+
+#endif // GUARD_suffstattable_h
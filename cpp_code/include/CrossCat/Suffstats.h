@@ -0,0 +1,62 @@
+/*
+ *   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+ *
+ *   Lead Developers: Dan Lovell and Jay Baxter
+ *   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+ *   Research Leads: Vikash Mansinghka, Patrick Shafto
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#ifndef GUARD_suffstats_h
+#define GUARD_suffstats_h
+
+#include <string>
+#include <vector>
+#include "utils.h"
+
+/**
+ * The sufficient statistics of one column's values within one cluster,
+ * with the column's hypers read once at construction.  Unlike a
+ * ComponentModel it keeps no running score, so inserting and removing
+ * elements is just bookkeeping and the marginal log probability is only
+ * computed when asked for.  View uses these to score columns it does not
+ * model against its row partition.
+ */
+class Suffstats
+{
+public:
+    Suffstats(const std::string &col_datatype, const CM_Hypers &hypers);
+    //
+    // calculators
+    double calc_marginal_logp() const;
+    //
+    // mutators
+    void insert_element(double element);
+    void remove_element(double element);
+private:
+    enum Datatype { CONTINUOUS, CYCLIC, MULTINOMIAL };
+    Datatype datatype;
+    // continuous: r, nu, s, mu; cyclic: kappa, a, b; multinomial:
+    // dirichlet_alpha
+    double hyper_0, hyper_1, hyper_2, hyper_3;
+    // continuous and cyclic: the log normalizer of the prior
+    double log_Z_0;
+    int count;
+    // continuous: sum_x, sum_x_squared; cyclic: sum_sin_x, sum_cos_x
+    double sum_0;
+    double sum_1;
+    // multinomial: count of each of the K values
+    std::vector<int> counts;
+};
+
+#endif // GUARD_suffstats_h
@@ -0,0 +1,73 @@
+/*
+ *   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+ *
+ *   Lead Developers: Dan Lovell and Jay Baxter
+ *   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+ *   Research Leads: Vikash Mansinghka, Patrick Shafto
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#ifndef GUARD_threadpool_h
+#define GUARD_threadpool_h
+
+#include <pthread.h>
+#include <vector>
+#include "utils.h"
+
+/**
+ * A unit of parallel work.  run is called exactly once for each task
+ * index in [0, num_tasks), possibly concurrently from different threads,
+ * so implementations must only touch state owned by that index.
+ */
+class ThreadPoolTask
+{
+public:
+    virtual ~ThreadPoolTask() {}
+    virtual void run(int task_idx) = 0;
+};
+
+/**
+ * A fixed set of worker threads that execute ThreadPoolTasks.  The thread
+ * calling run takes part in the work, so a pool of num_threads uses
+ * num_threads - 1 workers and a pool of one thread runs everything
+ * serially in the caller.
+ */
+class ThreadPool
+{
+public:
+    ThreadPool(int num_threads = 1);
+    ~ThreadPool();
+    int get_num_threads() const;
+    /**
+     * Call task.run(i) for each i in [0, num_tasks) and return once all
+     * calls have finished.
+     */
+    void run(ThreadPoolTask &task, int num_tasks);
+private:
+    DISALLOW_COPY_AND_ASSIGN(ThreadPool);
+    std::vector<pthread_t> workers;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_available;
+    pthread_cond_t work_done;
+    ThreadPoolTask *p_task;
+    int num_tasks;
+    int next_task_idx;
+    int num_unfinished;
+    bool shutting_down;
+    static void *worker_main(void *p_pool);
+    void worker_loop();
+    // called and returns with mutex held
+    void run_next_task();
+};
+
+#endif // GUARD_threadpool_h
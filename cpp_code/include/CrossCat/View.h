@@ -30,7 +30,11 @@
 #include "RandomNumberGenerator.h"
 #include "utils.h"
 #include "Cluster.h"
+#include "DataStore.h"
+#include "LgammaTable.h"
 #include "Matrix.h"
+#include "SuffstatTable.h"
+#include "Suffstats.h"
 #include "numerics.h"
 
 class Cluster;
@@ -96,9 +100,17 @@ public:
     double get_crp_alpha() const;
     std::vector<double> get_crp_alpha_grid() const;
     std::vector<std::string> get_hyper_strings(int which_col);
+    std::vector<HyperId> get_hyper_ids(int which_col);
     std::vector<double> get_hyper_grid(int global_col_idx,
         const std::string &which_hyper);
+    const std::vector<double> &get_hyper_grid(int global_col_idx,
+        HyperId which_hyper);
     CM_Hypers get_hypers(int local_col_idx) const;
+    /**
+     * The view's RandomNumberGenerator state, see
+     * RandomNumberGenerator::get_state
+     */
+    std::string get_rng_state() const;
     //
     // API helpers
     std::map<std::string, double> get_row_partition_model_hypers() const;
@@ -126,16 +138,34 @@ public:
     std::vector<double> calc_hyper_conditionals(int which_col,
         const std::string &which_hyper,
         const std::vector<double> &hyper_grid) const;
+    std::vector<double> calc_hyper_conditionals(int which_col,
+        HyperId which_hyper,
+        const std::vector<double> &hyper_grid) const;
     double calc_column_predictive_logp(const std::vector<double> &column_data,
         const std::string &col_datatype,
         const std::vector<int> &data_global_row_indices,
         const CM_Hypers &hypers) const;
+    /**
+     * Same as above for column global_col_idx of the DataStore, scored from
+     * per-cluster Suffstats built in one pass over the view's rows.
+     * Nothing is kept between calls, so a view's memory and its row moves
+     * don't grow with the columns it is scored against
+     */
+    double calc_column_predictive_logp(int global_col_idx,
+        const std::string &col_datatype,
+        const CM_Hypers &hypers) const;
     //
     // mutators
     void set_row_partitioning(const std::vector<std::vector<int> >
         &row_partitioning);
     void set_row_partitioning(const std::vector<int> &global_row_indices);
     double set_crp_alpha(double new_crp_alpha);
+    void set_rng_state(const std::string &rng_state);
+    /**
+     * Read row data from data_store rather than from caller supplied maps.
+     * data_store must outlive this view
+     */
+    void set_data_store(const DataStore &data_store);
     Cluster &get_new_cluster();
     double insert_row(const std::vector<double> &vd, Cluster &cd, int row_idx);
     double insert_row(const std::vector<double> &vd, int matching_row_idx,
@@ -147,6 +177,15 @@ public:
         const std::vector<int> &data_global_row_indices,
         int global_col_idx,
         CM_Hypers &hypers);
+    /**
+     * As insert_col, from the clusters' saved suffstats rather than the
+     * column's data: cluster_suffstats[cluster_idx] points at cluster
+     * cluster_idx's, laid out as for Cluster::insert_col_suffstats.
+     * O(#clusters), for State's snapshot constructor
+     */
+    double insert_col_suffstats(
+        const std::vector<const double *> &cluster_suffstats,
+        int global_col_idx, CM_Hypers &hypers);
     double insert_cols(const MatrixD &data,
         const std::vector<int> &global_row_indices,
         const std::vector<int> &global_col_indices,
@@ -155,27 +194,91 @@ public:
     void remove_all();
     double transition_z(const std::vector<double> &vd, int row_idx);
     double transition_zs(const std::map<int, std::vector<double> > &row_data_map);
+    /**
+     * Gibbs sample all row assignments, reading row data in place from
+     * the DataStore set with set_data_store
+     */
+    double transition_zs();
+    /**
+     * Gibbs sample the assignments of row_indices, in the given order,
+     * reading row data in place from the DataStore
+     */
+    double transition_zs(const std::vector<int> &row_indices);
+    /**
+     * Gibbs sample the assignments of num_rows rows drawn uniformly
+     * without replacement, for partial sweeps over very tall tables.
+     * The subset is drawn with this view's rng; num_rows at or above the
+     * number of rows is a full sweep
+     */
+    double transition_zs_subsample(int num_rows);
+    /**
+     * One sequentially allocated split-merge proposal (Dahl, 2003): pick
+     * two rows at random; if they share a cluster, propose splitting it
+     * by seating its other rows one by one next to either anchor, else
+     * propose merging their clusters, and accept by Metropolis-Hastings.
+     * Rows are read in place from the DataStore
+     */
+    double transition_split_merge();
+    /**
+     * num_proposals split-merge proposals.  The count must not depend on
+     * the partition, or the chain would no longer leave the posterior
+     * invariant
+     */
+    double transition_split_merges(int num_proposals);
     double transition_crp_alpha();
     double set_hyper(int which_col, const std::string &which_hyper,
         double new_value);
+    double set_hyper(int which_col, HyperId which_hyper, double new_value);
     double transition_hyper_i(int which_col, const std::string &which_hyper,
         const std::vector<double> &hyper_grid);
+    double transition_hyper_i(int which_col, HyperId which_hyper,
+        const std::vector<double> &hyper_grid);
     double transition_hyper_i(int which_col, const std::string &which_hyper);
+    double transition_hyper_i(int which_col, HyperId which_hyper);
     double transition_hypers_i(int which_col);
     double transition_hypers();
     double transition(const std::map<int, std::vector<double> > &row_data_map);
+    double transition();
     void increment_num_cols_effective();
     void decrement_num_cols_effective();
     //
     // data structures
     std::vector<Cluster *> clusters;
-    std::map<int, Cluster *> cluster_lookup;
+    // emptied clusters kept for reuse by get_new_cluster, so row Gibbs
+    // does not allocate and free a Cluster and its ComponentModels each
+    // time a row opens or closes a cluster.  They track column inserts and
+    // removals but not hyper updates; Cluster::reset catches those up.
+    std::vector<Cluster *> free_clusters;
+    // cluster of each row, indexed by row index; NULL for rows not in the
+    // view, as while transition_z moves a row
+    std::vector<Cluster *> row_clusters;
+    int num_vectors;
     std::vector<CM_Hypers *> hypers_v;
     //
     // helper functions
     std::vector<double> align_data(const std::vector<double> &values,
         const std::vector<int> &global_column_indices) const;
-    std::vector<int> shuffle_row_indices();
+    /**
+     * Fill row_order with the row indices in ascending order
+     */
+    void fill_row_order();
+    /**
+     * Permute the row indices into row_order and return it: starting
+     * from ascending order, for i from num_rows - 1 down to 1 swap slot
+     * i with slot draw_rand_i(i + 1).  O(num_rows), and reuses
+     * row_order's storage between sweeps.  The reference is valid until
+     * the next call
+     */
+    const std::vector<int> &shuffle_row_indices();
+    /**
+     * The rows of which_cluster in ascending order, from one scan of
+     * row_clusters
+     */
+    std::vector<int> get_row_indices(const Cluster &which_cluster) const;
+    /**
+     * The rows of each cluster in ascending order, from one scan of
+     * row_clusters
+     */
     std::vector<std::vector<int> > get_cluster_groupings() const;
     std::vector<int> get_canonical_clustering() const;
     //
@@ -188,12 +291,20 @@ public:
     // double score_test_set(const std::vector<std::vector<double> >& test_set) const;
     //
     // hyper inference grids FIXME: MOVE TO PRIVATE WHEN DONE TESTING
-    std::map<int, int> global_to_local; // FIXME: specify appicability to columns
+    // local slot of each global column index, -1 for columns not in the
+    // view, and the global column index of each local slot.  remove_col
+    // moves the last slot into the freed one, so local order is not
+    // insertion order
+    std::vector<int> global_to_local;
+    std::vector<int> local_to_global;
 private:
     // parameters
     double crp_alpha;
     double crp_score;
     double data_score;
+    // sum over clusters of lgamma(count), kept up to date by insert_row and
+    // remove_row for calc_crp_marginal(s)
+    double sum_log_gamma_counts;
     int num_cols_effective;
     std::map<int, std::string> global_col_datatypes;
     //  grids
@@ -208,11 +319,36 @@ private:
     std::map<int, std::vector<double> > vm_kappa_grids;
     // sub-objects
     RandomNumberGenerator rng;
+    const DataStore *p_data_store;
+    std::vector<double> row_buffer;
+    // row indices for shuffle_row_indices and the other row samplers
+    std::vector<int> row_order;
+    // columnar copy of the clusters' suffstats for row scoring
+    SuffstatTable suffstat_table;
+    std::vector<double> data_logps_buffer;
+    // cumulative weights for numerics::draw_sample_unnormalized
+    std::vector<double> sample_buffer;
+    // lgamma at counts shifted by crp_alpha_grid and multinomial_alpha_grid
+    // values; per View since views transition concurrently
+    mutable LgammaTable lgamma_table;
     // resources
     double draw_rand_u();
     int draw_rand_i(int max);
+    // row row_idx of the DataStore in this view's column order, empty for
+    // rows past the end of the store
+    void read_row(int row_idx, const std::vector<int> &global_ordering,
+        std::vector<double> &vd) const;
+    // log probabilities of seating vd in cluster a or in b, as in row
+    // Gibbs restricted to the two
+    void calc_two_cluster_logps(const std::vector<double> &vd,
+        const Cluster &a, const Cluster &b, double &logp_a,
+        double &logp_b) const;
     // helpers
     void construct_base_hyper_grids(int num_rows);
+    // p_row_data_map may be NULL, in which case rows are read from p_data_store
+    double transition_helper(
+        const std::map<int, std::vector<double> > *p_row_data_map);
+    int get_cluster_idx(const Cluster &which_cluster) const;
     void construct_column_hyper_grid(const std::vector<double> &col_data,
         int gobal_col_idx);
     /* CM_Hypers data_hypers; */
@@ -28,6 +28,7 @@
 #include <string>
 #include <map>
 #include "utils.h"
+#include "Hypers.h"
 
 static const double LOG_2PI = log(2.0 * M_PI);
 static const double HALF_LOG_2PI = .5 * LOG_2PI;
@@ -36,6 +37,8 @@ static const double LOG_2 = log(2.0);
 // use a namespce to hold all the functions?
 // http://stackoverflow.com/questions/6108704/renaming-namespaces
 
+class LgammaTable;
+
 namespace numerics
 {
 
@@ -48,22 +51,61 @@ double i_0(double x);
 double i_1(double x);
 
 double log_bessel_0(double x); // log I_0(x)
+// lgamma(x) via lgamma_r, which doesn't write the global signgam and so
+// is safe to call from ThreadPool workers
+double log_gamma(double x);
 
 double logaddexp(const std::vector<double> &logs);
+// log(sum_i exp(x[i])) for i < n, -inf for n = 0; with AVX2 the exps
+// are vectorized and good to a few ulps.  logaddexp above is this over
+// a vector
+double logsumexp(const double *x, int n);
+// out[i] = logsumexp of row i of the row-major num_rows x num_cols x
+void logsumexp_rows(const double *x, int num_rows, int num_cols,
+    double *out);
+// logsumexp of values seen one at a time, in one pass and O(1) space
+class OnlineLogSumExp
+{
+public:
+    OnlineLogSumExp();
+    void add(double x);
+    double get() const;
+private:
+    // largest value seen, and the sum of exp(x - maximum) over them
+    double maximum;
+    double sum;
+};
 
 // sampling given vector of logps or related
 int draw_sample_unnormalized(const std::vector<double> &unorm_logps,
     double rand_u);
+// as above, keeping the cumulative weights in scratch rather than
+// allocating them on every draw
+int draw_sample_unnormalized(const std::vector<double> &unorm_logps,
+    double rand_u, std::vector<double> &scratch);
 int draw_sample_with_partition(const std::vector<double> &unorm_logps,
     double log_partition, double rand_u);
 int crp_draw_sample(const std::vector<int> &counts, int sum_counts,
     double alpha, double rand_u);
+// alias table for repeated draws from one distribution
+void build_alias_table(const std::vector<double> &unorm_logps,
+    std::vector<double> &alias_probs, std::vector<int> &aliases);
+int draw_sample_alias(const std::vector<double> &alias_probs,
+    const std::vector<int> &aliases, double rand_u);
 
 // crp probability functions
 double calc_cluster_crp_logp(double cluster_weight, double sum_weights,
     double alpha);
 double calc_crp_alpha_conditional(const std::vector<int> &counts, double alpha,
     int sum_counts = -1, bool absolute = false);
+// as above, with the lgammas of counts and alpha looked up in lgamma_table
+double calc_crp_alpha_conditional(const std::vector<int> &counts, double alpha,
+    int sum_counts, bool absolute, LgammaTable &lgamma_table);
+// absolute p(alpha | clusters) from num_clusters, sum_counts and
+// sum_log_gammas, the sum of lgamma over the counts.  O(1) in time and
+// memory: only lgamma(alpha) goes through lgamma_table
+double calc_crp_alpha_conditional(int num_clusters, int sum_counts,
+    double sum_log_gammas, double alpha, LgammaTable &lgamma_table);
 std::vector<double> calc_crp_alpha_conditionals(const std::vector<double> &grid,
     const std::vector<int> &counts,
     bool absolute = false);
@@ -91,6 +133,36 @@ double calc_continuous_data_logp(int count,
     double s, double mu,
     double el,
     double score_0);
+/**
+ * The el-independent parts of the predictive logp of one more element in
+ * a continuous cluster with the given suffstats and marginal logp score,
+ * for add_continuous_predictive_logps
+ */
+void calc_continuous_predictive_terms(int count,
+    double sum_x, double sum_x_sq,
+    double r, double nu, double s, double mu,
+    double log_Z_0, double score,
+    double &mu_n, double &s_n, double &weight, double &half_nu, double &base);
+/**
+ * Add the predictive logp of el under each of num_clusters continuous
+ * clusters, described by the arrays of terms from
+ * calc_continuous_predictive_terms, to logps.  Vectorized with AVX2 when
+ * built with it; the result does not depend on that.
+ */
+void add_continuous_predictive_logps(double el, int num_clusters,
+    const double *mu_n, const double *s_n, const double *weight,
+    const double *half_nu, const double *base, double *logps);
+/**
+ * Sum over num_clusters continuous clusters, given as arrays of suffstats,
+ * of the calc_continuous_{r,nu,s,mu}_conditionals for which_hyper.  One
+ * pass over the clusters with the grid-only terms hoisted out and the logs
+ * over grid points batched (AVX2 when built with it).
+ */
+std::vector<double> calc_continuous_hyper_conditionals(HyperId which_hyper,
+    const std::vector<double> &hyper_grid,
+    int num_clusters, const int *count,
+    const double *sum_x, const double *sum_x_sq,
+    double r, double nu, double s, double mu);
 std::vector<double> calc_continuous_r_conditionals(
     const std::vector<double> &r_grid,
     int count,
@@ -142,6 +214,18 @@ std::vector<double> calc_multinomial_dirichlet_alpha_conditional(
     int count,
     const std::vector<int> &counts,
     int K);
+// as above, with the lgammas of counts and alpha looked up in lgamma_table
+double calc_multinomial_marginal_logp(int count,
+    const std::vector<int> &counts,
+    int K,
+    double dirichlet_alpha,
+    LgammaTable &lgamma_table);
+std::vector<double> calc_multinomial_dirichlet_alpha_conditional(
+    const std::vector<double> &dirichlet_alpha_grid,
+    int count,
+    const std::vector<int> &counts,
+    int K,
+    LgammaTable &lgamma_table);
 
 // cyclic component model functions
 //
@@ -43,6 +43,8 @@ uint32_t	crypto_weakprng_32(struct crypto_weakprng *);
 uint64_t	crypto_weakprng_64(struct crypto_weakprng *);
 void		crypto_weakprng_buf(struct crypto_weakprng *, void *, size_t);
 uintmax_t	crypto_weakprng_below(struct crypto_weakprng *, uintmax_t);
+void		crypto_weakprng_split(const struct crypto_weakprng *,
+		    struct crypto_weakprng *, uint64_t);
 
 int		crypto_weakprng_selftest(void);
 
@@ -0,0 +1,125 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Lead Developers: Dan Lovell and Jay Baxter
+*   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+*   Research Leads: Vikash Mansinghka, Patrick Shafto
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <cassert>
+
+#include "ChainEnsemble.h"
+
+using namespace std;
+
+// Runs n_steps of State::transition on chains[task_idx].  Each task only
+// touches its own chain and score slot.
+class ChainTransitionTask : public ThreadPoolTask
+{
+public:
+    ChainTransitionTask(const vector<State *> &chains, const MatrixD &data,
+        int n_steps) : chains(chains), data(data), n_steps(n_steps),
+        score_deltas(chains.size(), 0) {}
+    void run(int task_idx)
+    {
+        State &s = *chains[task_idx];
+        for (int step_idx = 0; step_idx < n_steps; step_idx++) {
+            score_deltas[task_idx] += s.transition(data);
+        }
+    }
+    const vector<double> &get_score_deltas() const
+    {
+        return score_deltas;
+    }
+private:
+    const vector<State *> &chains;
+    const MatrixD &data;
+    int n_steps;
+    vector<double> score_deltas;
+};
+
+ChainEnsemble::ChainEnsemble(const MatrixD &data,
+    const vector<string> &GLOBAL_COL_DATATYPES,
+    const vector<int> &GLOBAL_COL_MULTINOMIAL_COUNTS,
+    const vector<int> &global_row_indices,
+    const vector<int> &global_col_indices,
+    const vector<int> &SEEDS,
+    const string &col_initialization,
+    string row_initialization,
+    int N_GRID, int CT_KERNEL) : data_store(data), p_thread_pool(NULL)
+{
+    vector<int>::const_iterator it;
+    for (it = SEEDS.begin(); it != SEEDS.end(); ++it) {
+        State *p_chain = new State(data_store, GLOBAL_COL_DATATYPES,
+            GLOBAL_COL_MULTINOMIAL_COUNTS, global_row_indices,
+            global_col_indices, col_initialization, row_initialization,
+            empty_vector_double, empty_vector_double,
+            empty_vector_double, empty_vector_double,
+            N_GRID, *it, CT_KERNEL);
+        chains.push_back(p_chain);
+    }
+}
+
+ChainEnsemble::~ChainEnsemble()
+{
+    vector<State *>::iterator it;
+    for (it = chains.begin(); it != chains.end(); ++it) {
+        delete *it;
+    }
+    delete p_thread_pool;
+}
+
+int ChainEnsemble::get_num_chains() const
+{
+    return chains.size();
+}
+
+int ChainEnsemble::get_num_threads() const
+{
+    return p_thread_pool == NULL ? 1 : p_thread_pool->get_num_threads();
+}
+
+State &ChainEnsemble::get_chain(int chain_idx)
+{
+    assert(0 <= chain_idx && chain_idx < get_num_chains());
+    return *chains[chain_idx];
+}
+
+void ChainEnsemble::set_num_threads(int num_threads)
+{
+    assert(num_threads >= 1);
+    if (num_threads == get_num_threads()) {
+        return;
+    }
+    delete p_thread_pool;
+    p_thread_pool = NULL;
+    if (num_threads > 1) {
+        p_thread_pool = new ThreadPool(num_threads);
+    }
+}
+
+vector<double> ChainEnsemble::transition(const MatrixD &data, int n_steps)
+{
+    assert((int) data.size1() == data_store.get_num_rows());
+    assert((int) data.size2() == data_store.get_num_cols());
+    ChainTransitionTask task(chains, data, n_steps);
+    if (p_thread_pool == NULL) {
+        for (int chain_idx = 0; chain_idx < get_num_chains(); chain_idx++) {
+            task.run(chain_idx);
+        }
+    } else {
+        p_thread_pool->run(task, get_num_chains());
+    }
+    return task.get_score_deltas();
+}
@@ -36,7 +36,7 @@ Cluster::Cluster()
 void Cluster::delete_component_models(bool check_empty)
 {
     if (check_empty) {
-        assert(row_indices.size() == 0);
+        assert(count == 0);
     }
     while (p_model_v.size() != 0) {
         ComponentModel *p_cm = p_model_v.back();
@@ -45,6 +45,16 @@ void Cluster::delete_component_models(bool check_empty)
     }
 }
 
+void Cluster::reset()
+{
+    assert(count == 0);
+    score = 0;
+    vector<ComponentModel *>::iterator it;
+    for (it = p_model_v.begin(); it != p_model_v.end(); ++it) {
+        (**it).reset();
+    }
+}
+
 int Cluster::get_num_cols() const
 {
     return p_model_v.size();
@@ -52,7 +62,7 @@ int Cluster::get_num_cols() const
 
 int Cluster::get_count() const
 {
-    return row_indices.size();
+    return count;
 }
 
 double Cluster::get_marginal_logp() const
@@ -70,16 +80,6 @@ CM_Hypers Cluster::get_hypers_i(int idx) const
     return p_model_v[idx]->get_hypers();
 }
 
-set<int> Cluster::get_row_indices_set() const
-{
-    return row_indices;
-}
-
-vector<int> Cluster::get_row_indices_vector() const
-{
-    return set_to_vector(row_indices);
-}
-
 vector<double> Cluster::get_draw(int random_seed) const
 {
     RandomNumberGenerator rng(random_seed);
@@ -124,6 +124,14 @@ double Cluster::calc_row_predictive_logp(const vector<double> &values) const
 vector<double> Cluster::calc_hyper_conditionals(int which_col,
     const string &which_hyper,
     const vector<double> &hyper_grid) const
+{
+    return calc_hyper_conditionals(which_col, get_hyper_id(which_hyper),
+            hyper_grid);
+}
+
+vector<double> Cluster::calc_hyper_conditionals(int which_col,
+    HyperId which_hyper,
+    const vector<double> &hyper_grid) const
 {
     ComponentModel *cm = p_model_v[which_col];
     vector<double> hyper_conditionals = cm->calc_hyper_conditionals(which_hyper,
@@ -133,11 +141,9 @@ vector<double> Cluster::calc_hyper_conditionals(int which_col,
 
 double Cluster::calc_column_predictive_logp(const vector<double> &column_data,
     const string &col_datatype,
-    const vector<int> &data_global_row_indices,
+    const vector<int> &row_indices,
     const CM_Hypers &hypers)
 {
-    // FIXME: global_to_data must be used if not all rows are present
-    // map<int, int> global_to_data = construct_lookup_map(data_global_row_indices);
     ComponentModel *p_cm = NULL;
     if (col_datatype == CONTINUOUS_DATATYPE) {
         p_cm = new ContinuousComponentModel(hypers);
@@ -151,7 +157,7 @@ double Cluster::calc_column_predictive_logp(const vector<double> &column_data,
         assert(1 == 0);
         exit(EXIT_FAILURE);
     }
-    set<int>::const_iterator it;
+    vector<int>::const_iterator it;
     for (it = row_indices.begin(); it != row_indices.end(); ++it) {
         int global_row_idx = *it;
         // FIXME: global_to_data must be used if not all rows are present
@@ -168,14 +174,7 @@ double Cluster::calc_column_predictive_logp(const vector<double> &column_data,
 double Cluster::insert_row(const vector<double> &values, int row_idx)
 {
     double sum_score_deltas = 0;
-    // track row indices
-    pair<set<int>::iterator, bool> set_pair = \
-        row_indices.insert(row_idx);
-    if (!set_pair.second) {
-        cout << "Cluster::insert_row: !set_pair.second" << endl;
-        assert(set_pair.second);
-        exit(EXIT_FAILURE);
-    }
+    count++;
     // track score
     for (unsigned int col_idx = 0; col_idx < values.size(); col_idx++) {
         sum_score_deltas += p_model_v[col_idx]->insert_element(values[col_idx]);
@@ -187,13 +186,12 @@ double Cluster::insert_row(const vector<double> &values, int row_idx)
 double Cluster::remove_row(const vector<double> &values, int row_idx)
 {
     double sum_score_deltas = 0;
-    // track row indices
-    unsigned int num_removed = row_indices.erase(row_idx);
-    if (num_removed == 0) {
-        cout << "Cluster::remove_row: num_removed==0" << endl;
-        assert(num_removed != 0);
+    if (count == 0) {
+        cout << "Cluster::remove_row: count==0" << endl;
+        assert(count != 0);
         exit(EXIT_FAILURE);
     }
+    count--;
     // track score
     for (unsigned int col_idx = 0; col_idx < values.size(); col_idx++) {
         double value_to_remove = values[col_idx];
@@ -209,7 +207,8 @@ double Cluster::remove_col(int col_idx)
     double score_delta = p_model_v[col_idx]->calc_marginal_logp();
     // FIXME: make sure destruction proper
     ComponentModel *p_cm = p_model_v[col_idx];
-    p_model_v.erase(p_model_v.begin() + col_idx);
+    p_model_v[col_idx] = p_model_v.back();
+    p_model_v.pop_back();
     delete p_cm;
     score -= score_delta;
     return score_delta;
@@ -217,11 +216,9 @@ double Cluster::remove_col(int col_idx)
 
 double Cluster::insert_col(const vector<double> &data,
     const string &col_datatype,
-    const vector<int> &data_global_row_indices,
+    const vector<int> &row_indices,
     const CM_Hypers &hypers)
 {
-    // FIXME: global_to_data must be used if not all rows are present
-    // map<int, int> global_to_data = construct_lookup_map(data_global_row_indices);
     ComponentModel *p_cm = NULL;
     if (col_datatype == CONTINUOUS_DATATYPE) {
         p_cm = new ContinuousComponentModel(hypers);
@@ -233,7 +230,7 @@ double Cluster::insert_col(const vector<double> &data,
         cout << "ERROR: Cluster::insert_col: col_datatype=" << col_datatype << endl;
         abort();
     }
-    set<int>::const_iterator it;
+    vector<int>::const_iterator it;
     for (it = row_indices.begin(); it != row_indices.end(); ++it) {
         int global_row_idx = *it;
         // FIXME: global_to_data must be used if not all rows are present
@@ -249,6 +246,35 @@ double Cluster::insert_col(const vector<double> &data,
     return score_delta;
 }
 
+double Cluster::insert_col_suffstats(const double *suffstats,
+    const string &col_datatype, const CM_Hypers &hypers)
+{
+    ComponentModel *p_cm = NULL;
+    int count = static_cast<int>(suffstats[0]);
+    if (col_datatype == CONTINUOUS_DATATYPE) {
+        p_cm = new ContinuousComponentModel(hypers, count, suffstats[1],
+            suffstats[2]);
+    } else if (col_datatype == MULTINOMIAL_DATATYPE) {
+        int K = get(hypers, get_hyper_name(HYPER_K));
+        map<string, double> counts;
+        for (int key = 0; key < K; key++) {
+            counts[stringify(key)] = suffstats[1 + key];
+        }
+        p_cm = new MultinomialComponentModel(hypers, count, counts);
+    } else if (col_datatype == CYCLIC_DATATYPE) {
+        p_cm = new CyclicComponentModel(hypers, count, suffstats[1],
+            suffstats[2]);
+    } else {
+        cout << "ERROR: Cluster::insert_col_suffstats: col_datatype="
+            << col_datatype << endl;
+        abort();
+    }
+    double score_delta = p_cm->calc_marginal_logp();
+    p_model_v.push_back(p_cm);
+    score += score_delta;
+    return score_delta;
+}
+
 double Cluster::incorporate_hyper_update(int which_col)
 {
     double score_delta = p_model_v[which_col]->incorporate_hyper_update();
@@ -256,6 +282,15 @@ double Cluster::incorporate_hyper_update(int which_col)
     return score_delta;
 }
 
+double Cluster::incorporate_hyper_update(int which_col, HyperId which_hyper,
+    double value)
+{
+    double score_delta = p_model_v[which_col]->incorporate_hyper_update(
+            which_hyper, value);
+    score += score_delta;
+    return score_delta;
+}
+
 std::ostream &operator<<(std::ostream &os, const Cluster &c)
 {
     os << c.to_string() << endl;
@@ -267,7 +302,7 @@ string Cluster::to_string(const string &join_str, bool top_level) const
     stringstream ss;
     if (!top_level) {
         ss << "========" << std::endl;
-        ss <<  "row_indices:: " << row_indices;
+        ss <<  "count:: " << count;
         for (int col_idx = 0; col_idx < get_num_cols(); col_idx++) {
             ss << join_str << "column idx: " << col_idx << " :: ";
             ss << *(p_model_v[col_idx]);
@@ -281,6 +316,7 @@ string Cluster::to_string(const string &join_str, bool top_level) const
 void Cluster::init_columns(const vector<CM_Hypers *> &hypers_v)
 {
     score = 0;
+    count = 0;
     vector<CM_Hypers *>::const_iterator it;
     for (it = hypers_v.begin(); it != hypers_v.end(); ++it) {
         CM_Hypers &hypers = **it;
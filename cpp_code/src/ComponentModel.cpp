@@ -38,6 +38,21 @@ map<string, double> ComponentModel::get_suffstats() const
     return suffstats_out;
 }
 
+vector<double> ComponentModel::calc_hyper_conditionals(
+    const string &which_hyper, const vector<double> &hyper_grid) const
+{
+    return calc_hyper_conditionals(get_hyper_id(which_hyper), hyper_grid);
+}
+
+void ComponentModel::reset()
+{
+    count = 0;
+    incorporate_hyper_update();
+    init_suffstats();
+    set_log_Z_0();
+    score = 0;
+}
+
 std::ostream &operator<<(std::ostream &os, const ComponentModel &cm)
 {
     os << cm.to_string() << endl;
@@ -117,23 +117,23 @@ double ContinuousComponentModel::calc_element_predictive_logp_constrained(
 }
 
 vector<double> ContinuousComponentModel::calc_hyper_conditionals(
-    const string &which_hyper, const vector<double> &hyper_grid) const
+    HyperId which_hyper, const vector<double> &hyper_grid) const
 {
     double r, nu, s, mu;
     int count;
     double sum_x, sum_x_squared;
     get_hyper_doubles(r, nu, s, mu);
     get_suffstats(count, sum_x, sum_x_squared);
-    if (which_hyper == "r") {
+    if (which_hyper == HYPER_R) {
         return numerics::calc_continuous_r_conditionals(hyper_grid, count, sum_x,
                 sum_x_squared, nu, s, mu);
-    } else if (which_hyper == "nu") {
+    } else if (which_hyper == HYPER_NU) {
         return numerics::calc_continuous_nu_conditionals(hyper_grid, count, sum_x,
                 sum_x_squared, r, s, mu);
-    } else if (which_hyper == "s") {
+    } else if (which_hyper == HYPER_S) {
         return numerics::calc_continuous_s_conditionals(hyper_grid, count, sum_x,
                 sum_x_squared, r, nu, mu);
-    } else if (which_hyper == "mu") {
+    } else if (which_hyper == HYPER_MU) {
         return numerics::calc_continuous_mu_conditionals(hyper_grid, count, sum_x,
                 sum_x_squared, r, nu, s);
     } else {
@@ -182,6 +182,30 @@ double ContinuousComponentModel::incorporate_hyper_update()
     return score_delta;
 }
 
+double ContinuousComponentModel::incorporate_hyper_update(HyperId which_hyper,
+    double value)
+{
+    if (which_hyper == HYPER_R) {
+        hyper_r = value;
+    } else if (which_hyper == HYPER_NU) {
+        hyper_nu = value;
+    } else if (which_hyper == HYPER_S) {
+        hyper_s = value;
+    } else if (which_hyper == HYPER_MU) {
+        hyper_mu = value;
+    } else {
+        cout << "ContinuousComponentModel::incorporate_hyper_update: bad value for which_hyper="
+            << get_hyper_name(which_hyper) << endl;
+        assert(0);
+        exit(EXIT_FAILURE);
+    }
+    double score_0 = score;
+    set_log_Z_0();
+    score = calc_marginal_logp();
+    double score_delta = score - score_0;
+    return score_delta;
+}
+
 void ContinuousComponentModel::set_log_Z_0()
 {
     double r, nu, s, mu;
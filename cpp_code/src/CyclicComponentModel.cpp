@@ -119,20 +119,20 @@ double CyclicComponentModel::calc_element_predictive_logp_constrained(
 }
 
 vector<double> CyclicComponentModel::calc_hyper_conditionals(
-    const string &which_hyper, const vector<double> &hyper_grid) const
+    HyperId which_hyper, const vector<double> &hyper_grid) const
 {
     double kappa, a, b;
     int count;
     double sum_sin_x, sum_cos_x;
     get_hyper_doubles(kappa, a, b);
     get_suffstats(count, sum_sin_x, sum_cos_x);
-    if (which_hyper == "a") {
+    if (which_hyper == HYPER_A) {
         return numerics::calc_cyclic_a_conditionals(hyper_grid, count, sum_sin_x,
                 sum_cos_x, kappa, b);
-    } else if (which_hyper == "b") {
+    } else if (which_hyper == HYPER_B) {
         return numerics::calc_cyclic_b_conditionals(hyper_grid, count, sum_sin_x,
                 sum_cos_x, kappa, a);
-    } else if (which_hyper == "kappa") {
+    } else if (which_hyper == HYPER_KAPPA) {
         return numerics::calc_cyclic_kappa_conditionals(hyper_grid, count, sum_sin_x,
                 sum_cos_x, a, b);
     } else {
@@ -179,6 +179,28 @@ double CyclicComponentModel::incorporate_hyper_update()
     return score_delta;
 }
 
+double CyclicComponentModel::incorporate_hyper_update(HyperId which_hyper,
+    double value)
+{
+    if (which_hyper == HYPER_KAPPA) {
+        hyper_kappa = value;
+    } else if (which_hyper == HYPER_A) {
+        hyper_a = value;
+    } else if (which_hyper == HYPER_B) {
+        hyper_b = value;
+    } else {
+        cout << "CyclicComponentModel::incorporate_hyper_update: bad value for which_hyper="
+            << get_hyper_name(which_hyper) << endl;
+        assert(0);
+        exit(EXIT_FAILURE);
+    }
+    double score_0 = score;
+    set_log_Z_0();
+    score = calc_marginal_logp();
+    double score_delta = score - score_0;
+    return score_delta;
+}
+
 void CyclicComponentModel::set_log_Z_0()
 {
     double kappa, a, b;
@@ -230,23 +252,26 @@ double CyclicComponentModel::get_draw_constrained(int random_seed,
     // predictive pdf
     // FIXME: This will lead to a lot of rejections especially for high kappa
     RandomNumberGenerator gen(random_seed);
-    bool rejected = true;
+    // proposals are drawn a batch at a time: two uniforms each
+    const int batch_size = 32;
+    double u[2 * batch_size];
     double x; // random number
     double l_p;   // log proposal value
     double pdf_t; // log predictive probability
     double log_M = calc_element_predictive_logp_constrained(b, constraints);
     unsigned short int itr = 0;
-    while (rejected && itr < 1000) {
-        // generate random number in domain from proposal distribution
-        x = gen.next() * 2 * M_PI;
-        l_p = log(gen.next()) + log_M;
-        // get pdf at target
-        pdf_t = calc_element_predictive_logp_constrained(x, constraints);
-        if (l_p < pdf_t) {
-            rejected = false;
-            return x;
+    while (itr < 1000) {
+        gen.fill_uniform(u, 2 * batch_size);
+        for (int draw_idx = 0; draw_idx < batch_size; draw_idx++, itr++) {
+            // generate random number in domain from proposal distribution
+            x = u[2 * draw_idx] * 2 * M_PI;
+            l_p = log(u[2 * draw_idx + 1]) + log_M;
+            // get pdf at target
+            pdf_t = calc_element_predictive_logp_constrained(x, constraints);
+            if (l_p < pdf_t) {
+                return x;
+            }
         }
-        ++itr;
     }
     assert(false);
     return 0;         // XXXGCC
@@ -0,0 +1,101 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Lead Developers: Dan Lovell and Jay Baxter
+*   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+*   Research Leads: Vikash Mansinghka, Patrick Shafto
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <cassert>
+
+#include "DataStore.h"
+
+using namespace std;
+
+DataStore::DataStore(const MatrixD &data)
+{
+    num_rows = data.size1();
+    num_cols = data.size2();
+    values = data.get_column_major_view_data();
+    if (values != NULL) {
+        return;
+    }
+    owned_values.resize((size_t) num_rows * num_cols);
+    vector<double>::iterator it = owned_values.begin();
+    for (int col_idx = 0; col_idx < num_cols; col_idx++) {
+        for (int row_idx = 0; row_idx < num_rows; row_idx++) {
+            *it++ = data(row_idx, col_idx);
+        }
+    }
+    values = owned_values.empty() ? NULL : &owned_values[0];
+}
+
+int DataStore::get_num_rows() const
+{
+    return num_rows + appended_rows.size();
+}
+
+int DataStore::get_num_cols() const
+{
+    return num_cols;
+}
+
+double DataStore::get_value(int row_idx, int col_idx) const
+{
+    assert(0 <= row_idx && row_idx < get_num_rows());
+    assert(0 <= col_idx && col_idx < num_cols);
+    if (row_idx < num_rows) {
+        return values[(size_t) col_idx * num_rows + row_idx];
+    }
+    return appended_rows[row_idx - num_rows][col_idx];
+}
+
+void DataStore::get_row(int row_idx, const vector<int> &col_indices,
+    vector<double> &row_data) const
+{
+    int num_indices = col_indices.size();
+    row_data.resize(num_indices);
+    for (int idx = 0; idx < num_indices; idx++) {
+        row_data[idx] = get_value(row_idx, col_indices[idx]);
+    }
+}
+
+vector<double> DataStore::get_column(int col_idx) const
+{
+    assert(0 <= col_idx && col_idx < num_cols);
+    const double *begin = values + (size_t) col_idx * num_rows;
+    vector<double> col_data(begin, begin + num_rows);
+    vector<vector<double> >::const_iterator it;
+    for (it = appended_rows.begin(); it != appended_rows.end(); ++it) {
+        col_data.push_back((*it)[col_idx]);
+    }
+    return col_data;
+}
+
+vector<vector<double> > DataStore::get_columns(const vector<int> &col_indices)
+const
+{
+    vector<vector<double> > cols;
+    vector<int>::const_iterator it;
+    for (it = col_indices.begin(); it != col_indices.end(); ++it) {
+        cols.push_back(get_column(*it));
+    }
+    return cols;
+}
+
+void DataStore::append_row(const vector<double> &row_data)
+{
+    assert((int) row_data.size() == num_cols);
+    appended_rows.push_back(row_data);
+}
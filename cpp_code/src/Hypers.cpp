@@ -0,0 +1,56 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Lead Developers: Dan Lovell and Jay Baxter
+*   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+*   Research Leads: Vikash Mansinghka, Patrick Shafto
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+#include "Hypers.h"
+
+using namespace std;
+
+static const string HYPER_NAMES[NUM_HYPER_IDS] = {
+    "r",
+    "nu",
+    "s",
+    "mu",
+    "kappa",
+    "a",
+    "b",
+    "dirichlet_alpha",
+    "K",
+};
+
+HyperId get_hyper_id(const string &hyper_name)
+{
+    for (int hyper_id = 0; hyper_id < NUM_HYPER_IDS; hyper_id++) {
+        if (HYPER_NAMES[hyper_id] == hyper_name) {
+            return static_cast<HyperId>(hyper_id);
+        }
+    }
+    cout << "get_hyper_id: invalid hyper_name=" << hyper_name << endl;
+    assert(0);
+    exit(EXIT_FAILURE);
+}
+
+const string &get_hyper_name(HyperId hyper_id)
+{
+    assert(0 <= hyper_id && hyper_id < NUM_HYPER_IDS);
+    return HYPER_NAMES[hyper_id];
+}
@@ -0,0 +1,62 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Lead Developers: Dan Lovell and Jay Baxter
+*   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+*   Research Leads: Vikash Mansinghka, Patrick Shafto
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "LgammaTable.h"
+#include "numerics.h"
+
+using namespace std;
+
+const int LgammaTable::MAX_TABLE_N;
+
+LgammaTable::LgammaTable()
+{
+}
+
+double LgammaTable::lgamma_shifted(int n, double offset)
+{
+    assert(0 <= n);
+    if (n >= MAX_TABLE_N) {
+        return numerics::log_gamma(n + offset);
+    }
+    vector<double> &table = tables[offset];
+    if ((int) table.size() <= n) {
+        // lgamma is never NaN for the positive arguments used here, so
+        // NaN marks an entry not yet computed
+        table.resize(n + 1, numeric_limits<double>::quiet_NaN());
+    }
+    double &value = table[n];
+    if (isnan(value)) {
+        value = numerics::log_gamma(n + offset);
+    }
+    return value;
+}
+
+int LgammaTable::get_num_offsets() const
+{
+    return tables.size();
+}
+
+void LgammaTable::clear()
+{
+    tables.clear();
+}
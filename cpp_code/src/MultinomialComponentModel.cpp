@@ -64,7 +64,7 @@ MultinomialComponentModel::MultinomialComponentModel(const CM_Hypers &in_hypers,
 
 void MultinomialComponentModel::init_suffstats()
 {
-    suffstats.resize(hyper_K);
+    suffstats.assign(hyper_K, 0);
 }
 
 double MultinomialComponentModel::calc_marginal_logp() const
@@ -121,11 +121,11 @@ double MultinomialComponentModel::calc_element_predictive_logp_constrained(
 }
 
 vector<double> MultinomialComponentModel::calc_hyper_conditionals(
-    const string &which_hyper, const vector<double> &hyper_grid) const
+    HyperId which_hyper, const vector<double> &hyper_grid) const
 {
     const vector<int> &counts = suffstats;
     int K = hyper_K;
-    if (which_hyper == "dirichlet_alpha") {
+    if (which_hyper == HYPER_DIRICHLET_ALPHA) {
         return numerics::calc_multinomial_dirichlet_alpha_conditional(hyper_grid,
                 count,
                 counts,
@@ -133,7 +133,7 @@ vector<double> MultinomialComponentModel::calc_hyper_conditionals(
     } else {
         // error condition
         cout << "MultinomialComponentModel::calc_hyper_conditional: bad value for which_hyper="
-            << which_hyper << endl;
+            << get_hyper_name(which_hyper) << endl;
         assert(0);
         vector<double> vd;
         return vd;
@@ -180,6 +180,25 @@ double MultinomialComponentModel::incorporate_hyper_update()
     return score_delta;
 }
 
+double MultinomialComponentModel::incorporate_hyper_update(HyperId which_hyper,
+    double value)
+{
+    if (which_hyper == HYPER_DIRICHLET_ALPHA) {
+        hyper_dirichlet_alpha = value;
+    } else if (which_hyper == HYPER_K) {
+        hyper_K = value;
+    } else {
+        cout << "MultinomialComponentModel::incorporate_hyper_update: bad value for which_hyper="
+            << get_hyper_name(which_hyper) << endl;
+        assert(0);
+        exit(EXIT_FAILURE);
+    }
+    double score_0 = score;
+    score = calc_marginal_logp();
+    double score_delta = score - score_0;
+    return score_delta;
+}
+
 void MultinomialComponentModel::set_log_Z_0()
 {
     log_Z_0 = calc_marginal_logp();
@@ -217,6 +236,29 @@ double MultinomialComponentModel::get_draw(int random_seed) const
     return draw;
 }
 
+vector<double> MultinomialComponentModel::get_draws(int random_seed,
+    int num_draws) const
+{
+    vector<int> keys;
+    vector<double> log_counts_for_draw;
+    get_keys_counts_for_draw(keys, log_counts_for_draw, suffstats);
+    vector<double> alias_probs;
+    vector<int> aliases;
+    numerics::build_alias_table(log_counts_for_draw, alias_probs, aliases);
+    //
+    vector<double> draws(num_draws);
+    if (num_draws == 0) {
+        return draws;
+    }
+    RandomNumberGenerator(random_seed).fill_uniform(&draws[0], num_draws);
+    for (int draw_idx = 0; draw_idx < num_draws; draw_idx++) {
+        int key_idx = numerics::draw_sample_alias(alias_probs, aliases,
+                draws[draw_idx]);
+        draws[draw_idx] = static_cast<double>(keys[key_idx]);
+    }
+    return draws;
+}
+
 double MultinomialComponentModel::get_draw_constrained(int random_seed,
     const vector<double> &constraints) const
 {
@@ -23,6 +23,9 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
 #include <stdint.h>
 
 #include "RandomNumberGenerator.h"
@@ -55,6 +58,18 @@ static inline unsigned clz64(uint64_t x)
     return 64 - bitcount64(x);
 }
 
+// the bulk samplers draw keystream this many 64-bit words at a time
+static const size_t BULK_WORDS = 64;
+
+static inline uint64_t le64dec(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (unsigned i = 0; i < 8; i++) {
+        v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    }
+    return v;
+}
+
 //////////////////////////////////
 // return a random real between
 // 0 and 1 with uniform dist
@@ -86,6 +101,7 @@ double RandomNumberGenerator::next()
     return ldexp(static_cast<double>(s), e);
 }
 
+
 //////////////////////////////
 // return a random int bewteen
 // zero and max - 1 with uniform
@@ -139,6 +155,83 @@ double RandomNumberGenerator::stdgamma(double alpha)
     }
 }
 
+/////////////////////////////
+// bulk uniform samples: the top 53 bits of each
+// 64-bit word, offset by half a unit so that
+// neither 0 nor 1 comes out
+void RandomNumberGenerator::fill_uniform(double *out, size_t n)
+{
+    uint8_t keystream[8 * BULK_WORDS];
+    while (n > 0) {
+        const size_t m = std::min(n, BULK_WORDS);
+        crypto_weakprng_buf(&_weakprng, keystream, 8 * m);
+        for (size_t i = 0; i < m; i++) {
+            const uint64_t w = le64dec(keystream + 8 * i);
+            out[i] = ldexp(static_cast<double>(w >> 11) + 0.5, -53);
+        }
+        out += m;
+        n -= m;
+    }
+}
+
+/////////////////////////////
+// bulk standard normal samples: Box-Muller
+// with both the sine and the cosine used
+void RandomNumberGenerator::fill_stdnormal(double *out, size_t n)
+{
+    double u[BULK_WORDS];
+    while (n > 0) {
+        const size_t m = std::min(n, BULK_WORDS);
+        const size_t num_pairs = (m + 1) / 2;
+        fill_uniform(u, 2 * num_pairs);
+        for (size_t i = 0; i < num_pairs; i++) {
+            const double r = sqrt(-2 * log(u[2 * i]));
+            const double theta = 2 * M_PI * u[2 * i + 1];
+            out[2 * i] = r * sin(theta);
+            if (2 * i + 1 < m) {
+                out[2 * i + 1] = r * cos(theta);
+            }
+        }
+        out += m;
+        n -= m;
+    }
+}
+
+/////////////////////////////
+// bulk standard Gamma samples: Marsaglia & Tsang
+// as in stdgamma, with the normals and uniforms
+// for the proposals drawn in blocks
+void RandomNumberGenerator::fill_stdgamma(double *out, size_t n,
+        double alpha)
+{
+    const double d = alpha - (double)1 / 3;
+    const double c = 1 / sqrt(9 * d);
+    double x[BULK_WORDS];
+    double u[BULK_WORDS];
+    size_t j = BULK_WORDS;
+    size_t i = 0;
+    assert(1 <= alpha);
+    while (i < n) {
+        if (j == BULK_WORDS) {
+            fill_stdnormal(x, BULK_WORDS);
+            fill_uniform(u, BULK_WORDS);
+            j = 0;
+        }
+        const double x_j = x[j];
+        const double u_j = u[j];
+        j++;
+        double v = 1 + x_j * c;
+        if (v <= 0) {
+            continue;
+        }
+        v = v * v * v;
+        if (u_j < 1 - 0.0331 * ((x_j * x_j) * (x_j * x_j)) ||
+            log(u_j) < x_j * x_j / 2 + d - d * v + d * log(v)) {
+            out[i++] = d * v;
+        }
+    }
+}
+
 /////////////////////////////
 // chi^2 samples
 double RandomNumberGenerator::chisquare(double nu)
@@ -166,3 +259,28 @@ void RandomNumberGenerator::set_seed(std::time_t seed)
     }
     crypto_weakprng_seed(&_weakprng, seedbuf);
 }
+
+RandomNumberGenerator RandomNumberGenerator::split(uint64_t stream_id) const
+{
+    RandomNumberGenerator child;
+    crypto_weakprng_split(&_weakprng, &child._weakprng, stream_id);
+    return child;
+}
+
+std::string RandomNumberGenerator::get_state() const
+{
+    return std::string(reinterpret_cast<const char *>(&_weakprng),
+            sizeof(_weakprng));
+}
+
+void RandomNumberGenerator::set_state(const std::string &state)
+{
+    if (state.size() != sizeof(_weakprng)) {
+        std::cout << "RandomNumberGenerator::set_state: expected "
+            << sizeof(_weakprng) << " bytes, got " << state.size()
+            << std::endl;
+        assert(0);
+        exit(EXIT_FAILURE);
+    }
+    memcpy(&_weakprng, state.data(), sizeof(_weakprng));
+}
@@ -0,0 +1,212 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Lead Developers: Dan Lovell and Jay Baxter
+*   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+*   Research Leads: Vikash Mansinghka, Patrick Shafto
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include "Snapshot.h"
+
+using namespace std;
+
+static const char SNAPSHOT_MAGIC[8] = {'C', 'r', 'o', 's', 's', 'C', 'a', 't'};
+static const uint32_t SNAPSHOT_BYTE_ORDER_MARK = 0x01020304;
+
+SnapshotWriter::SnapshotWriter(const string &filename) : filename(filename)
+{
+    fp = fopen(filename.c_str(), "wb");
+    if (fp == NULL) {
+        throw runtime_error("SnapshotWriter: can't open " + filename);
+    }
+    // the destructor won't run if this throws
+    try {
+        write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        write_int(SNAPSHOT_VERSION);
+        write(&SNAPSHOT_BYTE_ORDER_MARK, sizeof(SNAPSHOT_BYTE_ORDER_MARK));
+    } catch (...) {
+        fclose(fp);
+        throw;
+    }
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    if (fp != NULL) {
+        fclose(fp);
+    }
+}
+
+void SnapshotWriter::write_int(int32_t value)
+{
+    write(&value, sizeof(value));
+}
+
+void SnapshotWriter::write_double(double value)
+{
+    write(&value, sizeof(value));
+}
+
+void SnapshotWriter::write_ints(const vector<int> &values)
+{
+    write_int(values.size());
+    vector<int32_t> values_32(values.begin(), values.end());
+    if (!values_32.empty()) {
+        write(&values_32[0], values_32.size() * sizeof(int32_t));
+    }
+}
+
+void SnapshotWriter::write_doubles(const vector<double> &values)
+{
+    write_int(values.size());
+    if (!values.empty()) {
+        write(&values[0], values.size() * sizeof(double));
+    }
+}
+
+void SnapshotWriter::write_string(const string &value)
+{
+    write_int(value.size());
+    write(value.data(), value.size());
+}
+
+void SnapshotWriter::close()
+{
+    assert(fp != NULL);
+    int status = fclose(fp);
+    fp = NULL;
+    if (status != 0) {
+        throw runtime_error("SnapshotWriter: can't write " + filename);
+    }
+}
+
+void SnapshotWriter::write(const void *data, size_t num_bytes)
+{
+    assert(fp != NULL);
+    if (fwrite(data, 1, num_bytes, fp) != num_bytes) {
+        throw runtime_error("SnapshotWriter: can't write " + filename);
+    }
+}
+
+SnapshotReader::SnapshotReader(const string &filename) : filename(filename)
+{
+    fp = fopen(filename.c_str(), "rb");
+    if (fp == NULL) {
+        fail("can't open");
+    }
+    // the destructor won't run if this throws
+    try {
+        read_header();
+    } catch (...) {
+        fclose(fp);
+        throw;
+    }
+}
+
+SnapshotReader::~SnapshotReader()
+{
+    fclose(fp);
+}
+
+int32_t SnapshotReader::read_int()
+{
+    int32_t value;
+    read(&value, sizeof(value));
+    return value;
+}
+
+double SnapshotReader::read_double()
+{
+    double value;
+    read(&value, sizeof(value));
+    return value;
+}
+
+vector<int> SnapshotReader::read_ints()
+{
+    int32_t size = read_size(sizeof(int32_t));
+    vector<int32_t> values_32(size);
+    if (size > 0) {
+        read(&values_32[0], size * sizeof(int32_t));
+    }
+    return vector<int>(values_32.begin(), values_32.end());
+}
+
+vector<double> SnapshotReader::read_doubles()
+{
+    int32_t size = read_size(sizeof(double));
+    vector<double> values(size);
+    if (size > 0) {
+        read(&values[0], size * sizeof(double));
+    }
+    return values;
+}
+
+string SnapshotReader::read_string()
+{
+    int32_t size = read_size(1);
+    string value(size, '\0');
+    if (size > 0) {
+        read(&value[0], size);
+    }
+    return value;
+}
+
+void SnapshotReader::read_header()
+{
+    if (fseek(fp, 0, SEEK_END) != 0 || (num_bytes_left = ftell(fp)) < 0
+        || fseek(fp, 0, SEEK_SET) != 0) {
+        fail("can't read");
+    }
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    read(magic, sizeof(magic));
+    if (memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0) {
+        fail("not a snapshot");
+    }
+    if (read_int() != SNAPSHOT_VERSION) {
+        fail("unsupported snapshot version");
+    }
+    uint32_t byte_order_mark;
+    read(&byte_order_mark, sizeof(byte_order_mark));
+    if (byte_order_mark != SNAPSHOT_BYTE_ORDER_MARK) {
+        fail("snapshot written with another byte order");
+    }
+}
+
+int32_t SnapshotReader::read_size(size_t element_size)
+{
+    int32_t size = read_int();
+    if (size < 0 || (size_t) size > (size_t) num_bytes_left / element_size) {
+        fail("corrupt snapshot");
+    }
+    return size;
+}
+
+void SnapshotReader::read(void *data, size_t num_bytes)
+{
+    if ((size_t) num_bytes_left < num_bytes
+        || fread(data, 1, num_bytes, fp) != num_bytes) {
+        fail("truncated snapshot");
+    }
+    num_bytes_left -= num_bytes;
+}
+
+void SnapshotReader::fail(const string &reason)
+{
+    throw runtime_error("SnapshotReader: " + reason + ": " + filename);
+}
@@ -19,12 +19,92 @@
 */
 #include <cassert>
 #include <cmath>
+#include <stdexcept>
 
 #include "State.h"
+#include "Snapshot.h"
 
 using namespace std;
 
-
+// Transitions views[task_idx] for State::run_view_tasks.  Each task
+// only touches its own view and score slot.  which_rows is only read by
+// ROWS tasks, count by SUBSAMPLE and SPLIT_MERGE ones.
+class ViewTransitionTask : public ThreadPoolTask
+{
+public:
+    enum Kind { FULL, ZS, ROWS, SUBSAMPLE, SPLIT_MERGE };
+    ViewTransitionTask(const vector<View *> &views, Kind kind,
+        const vector<int> &which_rows, int count = 0) :
+        views(views), kind(kind), which_rows(which_rows),
+        count(count), score_deltas(views.size(), 0) {}
+    void run(int task_idx)
+    {
+        View &v = *views[task_idx];
+        if (kind == FULL) {
+            score_deltas[task_idx] = v.transition();
+        } else if (kind == ZS) {
+            score_deltas[task_idx] = v.transition_zs();
+        } else if (kind == SUBSAMPLE) {
+            score_deltas[task_idx] = v.transition_zs_subsample(count);
+        } else if (kind == SPLIT_MERGE) {
+            score_deltas[task_idx] = v.transition_split_merges(count);
+        } else {
+            score_deltas[task_idx] = v.transition_zs(which_rows);
+        }
+    }
+    // summed in view order so the total doesn't depend on scheduling
+    double get_score_delta() const
+    {
+        return std::accumulate(score_deltas.begin(), score_deltas.end(), 0.);
+    }
+private:
+    const vector<View *> &views;
+    Kind kind;
+    const vector<int> &which_rows;
+    // rows per view for SUBSAMPLE tasks, proposals for SPLIT_MERGE ones
+    int count;
+    vector<double> score_deltas;
+};
+
+
+// Scores one feature against views[task_idx] for State::run_view_tasks.
+// Scoring only reads the State and its views, so tasks for different
+// views don't share any mutable state.
+class FeatureViewScoreTask : public ThreadPoolTask
+{
+public:
+    FeatureViewScoreTask(const State &state, const vector<View *> &views,
+        const vector<double> &col_data, const string &col_datatype,
+        const CM_Hypers &hypers, int global_col_idx) : state(state),
+        views(views), col_data(col_data), col_datatype(col_datatype),
+        hypers(hypers), global_col_idx(global_col_idx),
+        crp_logps(views.size()), data_logps(views.size()) {}
+    void run(int task_idx)
+    {
+        const View &v = *views[task_idx];
+        crp_logps[task_idx] = state.calc_feature_view_crp_logp(v,
+                global_col_idx);
+        data_logps[task_idx] = state.calc_feature_view_data_logp(col_data,
+                col_datatype, v, hypers, global_col_idx);
+    }
+    const vector<double> &get_crp_logps() const
+    {
+        return crp_logps;
+    }
+    const vector<double> &get_data_logps() const
+    {
+        return data_logps;
+    }
+private:
+    const State &state;
+    const vector<View *> &views;
+    const vector<double> &col_data;
+    const string &col_datatype;
+    const CM_Hypers &hypers;
+    int global_col_idx;
+    vector<double> crp_logps;
+    vector<double> data_logps;
+};
 // FIXME: shouldn't need T, not really using suffstats here
 State::State(const MatrixD &data,
     const vector<string> &GLOBAL_COL_DATATYPES,
@@ -42,12 +122,16 @@ State::State(const MatrixD &data,
     const vector<double> &COLUMN_CRP_ALPHA_GRID,
     const vector<double> &S_GRID,
     const vector<double> &MU_GRID,
-    int N_GRID, int SEED, int CT_KERNEL) : rng(SEED)
+    int N_GRID, int SEED, int CT_KERNEL) : rng(SEED),
+    p_owned_data_store(new DataStore(data)),
+    p_data_store(p_owned_data_store), p_thread_pool(NULL)
 {
     assert(CT_KERNEL == 1 || CT_KERNEL == 0);
     ct_kernel = CT_KERNEL;
     column_crp_score = 0;
     data_score = 0;
+    sum_log_gamma_view_counts = 0;
+    num_assigned_cols = 0;
     column_dependencies = col_ensure_dep;
     column_independencies = col_ensure_ind;
     num_cols_effective = get_vector_num_blocks(
@@ -57,15 +141,14 @@ State::State(const MatrixD &data,
     global_col_multinomial_counts = construct_lookup_map(global_col_indices,
             GLOBAL_COL_MULTINOMIAL_COUNTS);
     // construct grids
-    construct_base_hyper_grids(data, N_GRID, ROW_CRP_ALPHA_GRID,
+    construct_base_hyper_grids(N_GRID, ROW_CRP_ALPHA_GRID,
         COLUMN_CRP_ALPHA_GRID);
-    construct_column_hyper_grids(data, global_col_indices, GLOBAL_COL_DATATYPES,
+    construct_column_hyper_grids(global_col_indices, GLOBAL_COL_DATATYPES,
         S_GRID, MU_GRID);
     // actually build the state
     hypers_m = HYPERS_M;
     column_crp_alpha = COLUMN_CRP_ALPHA;
-    init_views(data,
-        global_row_indices, global_col_indices,
+    init_views(global_row_indices, global_col_indices,
         column_partition, row_partition_v,
         row_crp_alpha_v);
 }
@@ -81,50 +164,88 @@ State::State(const MatrixD &data,
     const vector<double> &COLUMN_CRP_ALPHA_GRID,
     const vector<double> &S_GRID,
     const vector<double> &MU_GRID,
-    int N_GRID, int SEED, int CT_KERNEL) : rng(SEED)
+    int N_GRID, int SEED, int CT_KERNEL) : rng(SEED),
+    p_owned_data_store(new DataStore(data)),
+    p_data_store(p_owned_data_store), p_thread_pool(NULL)
 {
-    assert(CT_KERNEL == 1 || CT_KERNEL == 0);
-    ct_kernel = CT_KERNEL;
-    column_crp_score = 0;
-    data_score = 0;
-    if (row_initialization == "") {
-        row_initialization = col_initialization;
+    init_from_prior(GLOBAL_COL_DATATYPES, GLOBAL_COL_MULTINOMIAL_COUNTS,
+        global_row_indices, global_col_indices, col_initialization,
+        row_initialization, ROW_CRP_ALPHA_GRID, COLUMN_CRP_ALPHA_GRID,
+        S_GRID, MU_GRID, N_GRID, CT_KERNEL);
+}
+
+State::State(DataStore &data_store,
+    const vector<string> &GLOBAL_COL_DATATYPES,
+    const vector<int> &GLOBAL_COL_MULTINOMIAL_COUNTS,
+    const vector<int> &global_row_indices,
+    const vector<int> &global_col_indices,
+    const string &col_initialization,
+    string row_initialization,
+    const vector<double> &ROW_CRP_ALPHA_GRID,
+    const vector<double> &COLUMN_CRP_ALPHA_GRID,
+    const vector<double> &S_GRID,
+    const vector<double> &MU_GRID,
+    int N_GRID, int SEED, int CT_KERNEL) : rng(SEED),
+    p_owned_data_store(NULL), p_data_store(&data_store),
+    p_thread_pool(NULL)
+{
+    init_from_prior(GLOBAL_COL_DATATYPES, GLOBAL_COL_MULTINOMIAL_COUNTS,
+        global_row_indices, global_col_indices, col_initialization,
+        row_initialization, ROW_CRP_ALPHA_GRID, COLUMN_CRP_ALPHA_GRID,
+        S_GRID, MU_GRID, N_GRID, CT_KERNEL);
+}
+
+State::State(const MatrixD &data, const string &snapshot_filename) :
+    p_owned_data_store(new DataStore(data)),
+    p_data_store(p_owned_data_store), p_thread_pool(NULL)
+{
+    // the destructor won't run if this throws
+    try {
+        load_snapshot(snapshot_filename);
+    } catch (...) {
+        remove_all();
+        delete p_owned_data_store;
+        throw;
     }
-    num_cols_effective = global_col_indices.size();
-    global_col_datatypes = construct_lookup_map(global_col_indices,
-            GLOBAL_COL_DATATYPES);
-    global_col_multinomial_counts = construct_lookup_map(global_col_indices,
-            GLOBAL_COL_MULTINOMIAL_COUNTS);
-    // construct grids
-    construct_base_hyper_grids(data, N_GRID, ROW_CRP_ALPHA_GRID,
-        COLUMN_CRP_ALPHA_GRID);
-    construct_column_hyper_grids(data, global_col_indices, GLOBAL_COL_DATATYPES,
-        S_GRID, MU_GRID);
-    //
-    init_column_hypers(global_col_indices);
-    column_crp_alpha = sample_column_crp_alpha();
-    vector<vector<int> > column_partition = generate_col_partition(
-            global_col_indices,
-            col_initialization);
-    vector<double> row_crp_alpha_v = sample_row_crp_alphas(
-            column_partition.size());
-    vector<vector<vector<int> > > row_partition_v = generate_row_partitions(
-            global_row_indices,
-            row_crp_alpha_v, row_initialization);
-    init_views(data,
-        global_row_indices, global_col_indices,
-        column_partition, row_partition_v,
-        row_crp_alpha_v);
 }
 
 State::~State()
 {
     remove_all();
+    delete p_thread_pool;
+    delete p_owned_data_store;
+}
+
+int State::get_num_threads() const
+{
+    return p_thread_pool == NULL ? 1 : p_thread_pool->get_num_threads();
+}
+
+void State::set_rng_states(const vector<string> &rng_states)
+{
+    assert((int) rng_states.size() == get_num_views() + 1);
+    rng.set_state(rng_states[0]);
+    for (int view_idx = 0; view_idx < get_num_views(); view_idx++) {
+        views[view_idx]->set_rng_state(rng_states[view_idx + 1]);
+    }
+}
+
+void State::set_num_threads(int num_threads)
+{
+    assert(num_threads >= 1);
+    if (num_threads == get_num_threads()) {
+        return;
+    }
+    delete p_thread_pool;
+    p_thread_pool = NULL;
+    if (num_threads > 1) {
+        p_thread_pool = new ThreadPool(num_threads);
+    }
 }
 
 int State::get_num_cols() const
 {
-    return view_lookup.size();
+    return num_assigned_cols;
 }
 
 int State::get_num_cols_effective() const
@@ -155,7 +276,12 @@ double State::insert_row(const vector<double> &row_data,
 {
     bool append_row = (row_idx == -1);
     if (append_row) {
-        row_idx = (int)(**views.begin()).cluster_lookup.size();
+        row_idx = (int)(**views.begin()).get_num_vectors();
+    }
+    if (row_idx == p_data_store->get_num_rows()) {
+        // a shared store is read by other States too
+        assert(p_data_store == p_owned_data_store);
+        p_data_store->append_row(row_data);
     }
     vector<View *>::const_iterator it;
     double score_delta = 0;
@@ -194,7 +320,17 @@ double State::insert_feature(int feature_idx,
     which_view.insert_col(feature_data,
         data_global_row_indices, feature_idx,
         hypers);
+    // lgamma(num_cols) - lgamma(num_cols - 1); a new view adds lgamma(1) = 0
+    int view_num_cols = which_view.get_num_cols();
+    if (view_num_cols > 1) {
+        sum_log_gamma_view_counts += log(view_num_cols - 1);
+    }
+    if (feature_idx >= (int) view_lookup.size()) {
+        view_lookup.resize(feature_idx + 1, NULL);
+    }
+    assert(view_lookup[feature_idx] == NULL);
     view_lookup[feature_idx] = &which_view;
+    num_assigned_cols++;
     column_crp_score += crp_logp_delta;
     data_score += data_logp_delta;
     return score_delta;
@@ -208,7 +344,8 @@ double State::sample_insert_feature(int feature_idx,
     vector<double> unorm_logps = calc_feature_view_predictive_logps(feature_data,
             feature_idx);
     double rand_u = draw_rand_u();
-    int draw = numerics::draw_sample_unnormalized(unorm_logps, rand_u);
+    int draw = numerics::draw_sample_unnormalized(unorm_logps, rand_u,
+        sample_buffer);
     View &which_view = get_view(draw);
     double score_delta = insert_feature(feature_idx, feature_data, which_view);
     remove_if_empty(singleton_view);
@@ -227,7 +364,7 @@ double State::sample_insert_feature_block(
 
     double rand_u = draw_rand_u();
     int draw = numerics::draw_sample_unnormalized(
-        unorm_predictive_logps, rand_u);
+        unorm_predictive_logps, rand_u, sample_buffer);
     View &which_view = get_view(draw);
 
     // Insert features in the block and aggregate the score_delta.
@@ -248,11 +385,15 @@ double State::remove_feature(
 {
     string col_datatype = global_col_datatypes[feature_idx];
     CM_Hypers &hypers = hypers_m[feature_idx];
-    map<int, View *>::iterator it = view_lookup.find(feature_idx);
-    assert(it != view_lookup.end());
-    View &which_view = *(it->second);
-    view_lookup.erase(it);
+    assert(view_lookup[feature_idx] != NULL);
+    View &which_view = *view_lookup[feature_idx];
+    view_lookup[feature_idx] = NULL;
+    num_assigned_cols--;
     double data_logp_delta = which_view.remove_col(feature_idx);
+    int view_num_cols = which_view.get_num_cols();
+    if (view_num_cols > 0) {
+        sum_log_gamma_view_counts -= log(view_num_cols);
+    }
     double crp_logp_delta, other_data_logp_delta;
     double score_delta = calc_feature_view_predictive_logp(
         feature_data,
@@ -274,9 +415,8 @@ double State::remove_feature(
     View *&p_singleton_view)
 {
     // Retrieve current view of feature_idx.
-    map<int, View *>::iterator it = view_lookup.find(feature_idx);
-    assert(it != view_lookup.end());
-    View &which_view = *(it->second);
+    assert(view_lookup[feature_idx] != NULL);
+    View &which_view = *view_lookup[feature_idx];
 
     // If current view is already a singleton then reuse it.
     if (which_view.get_num_cols() == 1) {
@@ -309,8 +449,7 @@ double State::transition_feature_block_gibbs(
 
     // Retrieve the current view of feature_idxs[0]. They should all be in
     // the same view, since we are transitioning features which are dependent.
-    map<int, View *>::iterator it = view_lookup.find(feature_idxs[0]);
-    View &current_view = *(it->second);
+    View &current_view = *view_lookup[feature_idxs[0]];
 
     // If current view only contains feature_idxs, then reuse it.
     // Otherwise create a new singleton view as the proposal.
@@ -333,7 +472,7 @@ double State::transition_feature_block_gibbs(
 
     // Increment the effective num cols.
     increment_num_cols_effective();
-    view_lookup.find(feature_idxs[0])->second->increment_num_cols_effective();
+    view_lookup[feature_idxs[0]]->increment_num_cols_effective();
 
     return score_delta;
 }
@@ -446,10 +585,14 @@ double State::transition_features(
 
     double score_delta = 0;
 
+    // Feature data is read from data_store; data is only checked for
+    // consistency.
+    assert((int) data.size2() == p_data_store->get_num_cols());
+
     // Determine which features to transition.
     int num_features = which_features.size();
     if (num_features == 0) {
-        which_features = create_sequence(data.size2());
+        which_features = create_sequence(p_data_store->get_num_cols());
         random_shuffle(which_features.begin(), which_features.end(), rng);
     }
 
@@ -463,13 +606,13 @@ double State::transition_features(
         if (ct_kernel == 0) {
             // For Gibbs, transition feature and all its dependent features.
             vector<int> feature_idxs = get_column_dependencies(feature_idx);
-            vector<vector<double> > feature_datas = extract_cols(data,
+            vector<vector<double> > feature_datas = p_data_store->get_columns(
                 feature_idxs);
             score_delta += transition_feature_block_gibbs(
                 feature_idxs, feature_datas);
         } else if (ct_kernel == 1) {
             // For MH, transition the feature alone without dependent features.
-            vector<double> feature_data = extract_col(data, feature_idx);
+            vector<double> feature_data = p_data_store->get_column(feature_idx);
             score_delta += transition_feature_mh(feature_idx, feature_data);
         } else {
             printf("Invalid CT_KERNEL");
@@ -496,6 +639,7 @@ View &State::get_new_view()
         s_grids, mu_grids,
         vm_a_grids, vm_kappa_grids,
         draw_rand_i());
+    p_new_view->set_data_store(*p_data_store);
     views.push_back(p_new_view);
     return *p_new_view;
 }
@@ -525,6 +669,8 @@ void State::remove_if_empty(View &which_view)
 void State::remove_all()
 {
     view_lookup.clear();
+    num_assigned_cols = 0;
+    sum_log_gamma_view_counts = 0;
     vector<View *>::const_iterator it;
     for (it = views.begin(); it != views.end(); ++it) {
         View &view = **it;
@@ -607,7 +753,13 @@ map<string, double> State::get_column_partition_hypers() const
 
 vector<int> State::get_column_partition_assignments() const
 {
-    return define_group_ordering(view_lookup, views);
+    map<View *, int> view_to_int = vector_to_map(views);
+    vector<int> assignments;
+    assignments.reserve(num_assigned_cols);
+    for (int col_idx = 0; col_idx < num_assigned_cols; col_idx++) {
+        assignments.push_back(view_to_int[view_lookup[col_idx]]);
+    }
+    return assignments;
 }
 
 vector<int> State::get_column_partition_counts() const
@@ -672,6 +824,17 @@ vector<vector<int> > State::get_X_D() const
     return X_D;
 }
 
+vector<string> State::get_rng_states() const
+{
+    vector<string> rng_states;
+    rng_states.push_back(rng.get_state());
+    vector<View *>::const_iterator it;
+    for (it = views.begin(); it != views.end(); ++it) {
+        rng_states.push_back((**it).get_rng_state());
+    }
+    return rng_states;
+}
+
 vector<double> State::get_draw(int row_idx, int random_seed) const
 {
     RandomNumberGenerator rng(random_seed);
@@ -699,7 +862,12 @@ vector<double> State::get_draw(int row_idx, int random_seed) const
 map<int, vector<int> > State::get_column_groups() const
 {
     map<View *, int> view_to_int = vector_to_map(views);
-    map<View *, set<int> > view_to_set = group_by_value(view_lookup);
+    map<View *, set<int> > view_to_set;
+    for (size_t col_idx = 0; col_idx < view_lookup.size(); col_idx++) {
+        if (view_lookup[col_idx] != NULL) {
+            view_to_set[view_lookup[col_idx]].insert(col_idx);
+        }
+    }
     map<int, vector<int> > view_idx_to_vec;
     vector<View *>::const_iterator it;
     for (it = views.begin(); it != views.end(); ++it) {
@@ -725,37 +893,26 @@ double State::transition_view_i(int which_view,
 // helper for cython
 double State::transition_view_i(int which_view, const MatrixD &data)
 {
-    vector<int> global_column_indices = create_sequence(data.size2());
+    // rows are read in place from data_store
+    assert((int) data.size2() == p_data_store->get_num_cols());
     View &v = get_view(which_view);
-    vector<int> view_cols = get_indices_to_reorder(global_column_indices,
-            v.global_to_local);
-    const MatrixD data_subset = extract_columns(data, view_cols);
-    map<int, vector<double> > data_subset_map = construct_data_map(data_subset);
-    return v.transition(data_subset_map);
+    return v.transition();
 }
 
 double State::transition_views(const MatrixD &data)
 {
-    vector<int> global_column_indices = create_sequence(data.size2());
-    //
-    double score_delta = 0;
+    assert((int) data.size2() == p_data_store->get_num_cols());
     // ordering doesn't matter, don't need to shuffle
-    for (int view_idx = 0; view_idx < get_num_views(); view_idx++) {
-        View &v = get_view(view_idx);
-        vector<int> view_cols = get_indices_to_reorder(global_column_indices,
-                v.global_to_local);
-        const MatrixD data_subset = extract_columns(data, view_cols);
-        map<int, vector<double> > data_subset_map = construct_data_map(data_subset);
-        score_delta += v.transition(data_subset_map);
-    }
-    return score_delta;
+    vector<int> all_rows;
+    ViewTransitionTask task(views, ViewTransitionTask::FULL, all_rows);
+    run_view_tasks(task);
+    return task.get_score_delta();
 }
 
 double State::transition_row_partition_assignments(const MatrixD &data,
     vector<int> which_rows)
 {
-    vector<int> global_column_indices = create_sequence(data.size2());
-    double score_delta = 0;
+    assert((int) data.size2() == p_data_store->get_num_cols());
     //
     int num_rows = which_rows.size();
     if (num_rows == 0) {
@@ -763,44 +920,62 @@ double State::transition_row_partition_assignments(const MatrixD &data,
         which_rows = create_sequence(num_rows);
         random_shuffle(which_rows.begin(), which_rows.end(), rng);
     }
-    vector<View *>::const_iterator svp_it;
-    for (svp_it = views.begin(); svp_it != views.end(); ++svp_it) {
-        // for each view
-        View &v = **svp_it;
-        vector<int> view_cols = get_indices_to_reorder(global_column_indices,
-                v.global_to_local);
-        const MatrixD data_subset = extract_columns(data, view_cols);
-        map<int, vector<double> > row_data_map = construct_data_map(data_subset);
-        vector<int>::const_iterator vi_it;
-        for (vi_it = which_rows.begin(); vi_it != which_rows.end(); ++vi_it) {
-            // for each SPECIFIED row
-            int row_idx = *vi_it;
-            vector<double> vd = row_data_map[row_idx];
-            score_delta += v.transition_z(vd, row_idx);
-        }
-    }
+    ViewTransitionTask task(views, ViewTransitionTask::ROWS, which_rows);
+    run_view_tasks(task);
+    double score_delta = task.get_score_delta();
+    data_score += score_delta;
+    return score_delta;
+}
+
+double State::transition_row_partition_subsample(const MatrixD &data,
+    int num_rows)
+{
+    assert((int) data.size2() == p_data_store->get_num_cols());
+    vector<int> all_rows;
+    ViewTransitionTask task(views, ViewTransitionTask::SUBSAMPLE, all_rows,
+        num_rows);
+    run_view_tasks(task);
+    double score_delta = task.get_score_delta();
+    data_score += score_delta;
+    return score_delta;
+}
+
+double State::transition_row_partition_split_merge(const MatrixD &data,
+    int num_proposals)
+{
+    assert((int) data.size2() == p_data_store->get_num_cols());
+    vector<int> all_rows;
+    ViewTransitionTask task(views, ViewTransitionTask::SPLIT_MERGE, all_rows,
+        num_proposals);
+    run_view_tasks(task);
+    double score_delta = task.get_score_delta();
     data_score += score_delta;
     return score_delta;
 }
 
 double State::transition_views_zs(const MatrixD &data)
 {
-    vector<int> global_column_indices = create_sequence(data.size2());
-    //
-    double score_delta = 0;
+    assert((int) data.size2() == p_data_store->get_num_cols());
     // ordering doesn't matter, don't need to shuffle
-    for (int view_idx = 0; view_idx < get_num_views(); view_idx++) {
-        View &v = get_view(view_idx);
-        vector<int> view_cols = get_indices_to_reorder(global_column_indices,
-                v.global_to_local);
-        const MatrixD data_subset = extract_columns(data, view_cols);
-        map<int, vector<double> > data_subset_map = construct_data_map(data_subset);
-        score_delta += v.transition_zs(data_subset_map);
-    }
+    vector<int> all_rows;
+    ViewTransitionTask task(views, ViewTransitionTask::ZS, all_rows);
+    run_view_tasks(task);
+    double score_delta = task.get_score_delta();
     data_score += score_delta;
     return score_delta;
 }
 
+void State::run_view_tasks(ThreadPoolTask &task) const
+{
+    if (p_thread_pool == NULL) {
+        for (int view_idx = 0; view_idx < get_num_views(); view_idx++) {
+            task.run(view_idx);
+        }
+    } else {
+        p_thread_pool->run(task, get_num_views());
+    }
+}
+
 double State::transition_views_row_partition_hyper()
 {
     double score_delta = 0;
@@ -842,7 +1017,7 @@ double State::transition_column_hyperparameters(vector<int> which_cols)
     // Use all columns by default.
     int num_cols = which_cols.size();
     if (num_cols == 0) {
-        num_cols = view_lookup.size();
+        num_cols = num_assigned_cols;
         which_cols = create_sequence(num_cols);
         random_shuffle(which_cols.begin(), which_cols.end(), rng);
     }
@@ -914,10 +1089,11 @@ double State::calc_feature_view_data_logp(
     const CM_Hypers &hypers,
     const int &global_col_idx) const
 {
-    // Compute data log probability.
-    vector<int> data_global_row_indices = create_sequence(col_data.size());
+    // Compute data log probability.  col_data is column global_col_idx of
+    // data_store, which the view reads in place.
+    assert((int) col_data.size() == p_data_store->get_num_rows());
     double data_log_delta = v.calc_column_predictive_logp(
-        col_data, col_datatype, data_global_row_indices, hypers);
+        global_col_idx, col_datatype, hypers);
     return data_log_delta;
 }
 
@@ -948,12 +1124,12 @@ bool State::view_violates_independency(
     // Find the independence constraints for global_col_idx.
     set<int> indeps = column_independencies.find(global_col_idx)->second;
     // Check whether any columns in the view is a violator.
-    map<int, int>::const_iterator it;
-    for (it = view.global_to_local.begin();
-        it != view.global_to_local.end();
+    vector<int>::const_iterator it;
+    for (it = view.local_to_global.begin();
+        it != view.local_to_global.end();
         ++it) {
         // Violator found.
-        if (indeps.count(it->first) > 0){
+        if (indeps.count(*it) > 0){
             return true;
         }
     }
@@ -965,23 +1141,13 @@ vector<double> State::calc_feature_view_predictive_logps(
     const vector<double> &col_data,
     int global_col_idx) const
 {
-    vector<double> logps;
     CM_Hypers hypers = get(hypers_m, global_col_idx);
-    vector<View *>::const_iterator it;
-    double crp_log_delta, data_log_delta;
     string col_datatype = get(global_col_datatypes, global_col_idx);
-    for (it = views.begin(); it != views.end(); ++it) {
-        View &v = **it;
-        double score_delta = calc_feature_view_predictive_logp(col_data,
-                col_datatype,
-                v,
-                crp_log_delta,
-                data_log_delta,
-                hypers,
-                global_col_idx);
-        logps.push_back(score_delta);
-    }
-    return logps;
+    FeatureViewScoreTask task(*this, views, col_data, col_datatype, hypers,
+        global_col_idx);
+    run_view_tasks(task);
+    // data + crp per view, as calc_feature_view_predictive_logp adds them
+    return std_vector_add(task.get_data_logps(), task.get_crp_logps());
 }
 
 vector<double> State::calc_feature_view_predictive_logps_block(
@@ -993,13 +1159,16 @@ vector<double> State::calc_feature_view_predictive_logps_block(
     vector<vector<double> > unorm_data_logps_all;
 
     // Compute crp_logp and data_logp for each feature.
+    // The views are scored in parallel; each feature's scores land in view
+    // order, so the sums below don't depend on scheduling.
     for (size_t i = 0; i < feature_idxs.size(); ++i) {
+        CM_Hypers hypers = get(hypers_m, feature_idxs[i]);
         string col_datatype = get(global_col_datatypes, feature_idxs[i]);
-        vector<double> crp_logps = calc_feature_view_crp_logps(feature_idxs[i]);
-        vector<double> data_logps = calc_feature_view_data_logps(
-            feature_datas[i], feature_idxs[i]);
-        unorm_crp_logps_all.push_back(crp_logps);
-        unorm_data_logps_all.push_back(data_logps);
+        FeatureViewScoreTask task(*this, views, feature_datas[i],
+            col_datatype, hypers, feature_idxs[i]);
+        run_view_tasks(task);
+        unorm_crp_logps_all.push_back(task.get_crp_logps());
+        unorm_data_logps_all.push_back(task.get_data_logps());
     }
 
     // Sum the data_logps across the features.
@@ -1064,26 +1233,26 @@ vector<double> State::calc_feature_view_data_logps(
 
 double State::calc_column_crp_marginal() const
 {
-    vector<int> view_counts = get_view_counts();
     int num_cols = get_num_cols_effective();
-    return numerics::calc_crp_alpha_conditional(view_counts, column_crp_alpha,
-            num_cols, true);
+    return numerics::calc_crp_alpha_conditional(get_num_views(), num_cols,
+            sum_log_gamma_view_counts, column_crp_alpha, lgamma_table);
 }
 
 vector<double> State::calc_column_crp_marginals(const vector<double>
     &alphas_to_score)
 const
 {
-    vector<int> view_counts = get_view_counts();
+    int num_views = get_num_views();
     vector<double> crp_scores;
     vector<double>::const_iterator it = alphas_to_score.begin();
     int num_cols = get_num_cols_effective();
     for (; it != alphas_to_score.end(); ++it) {
         double alpha_to_score = *it;
-        double this_crp_score = numerics::calc_crp_alpha_conditional(view_counts,
-                alpha_to_score,
+        double this_crp_score = numerics::calc_crp_alpha_conditional(num_views,
                 num_cols,
-                true);
+                sum_log_gamma_view_counts,
+                alpha_to_score,
+                lgamma_table);
         crp_scores.push_back(this_crp_score);
     }
     return crp_scores;
@@ -1092,13 +1261,12 @@ const
 double State::calc_row_predictive_logp(const vector<double> &in_vd)
 {
     vector<double> view_sum_predictive_logps;
-    vector<int> global_column_indices = create_sequence(in_vd.size());
     vector<View *>::const_iterator svp_it;
     for (svp_it = views.begin(); svp_it != views.end(); ++svp_it) {
         // for each view
         View &v = **svp_it;
-        vector<int> view_cols = get_indices_to_reorder(global_column_indices,
-                v.global_to_local);
+        // in_vd is indexed by global column index
+        const vector<int> &view_cols = v.local_to_global;
         vector<double> use_vd = extract_columns(in_vd, view_cols);
         vector<double> this_view_predictive_logps = \
             v.calc_cluster_vector_predictive_logps(use_vd);
@@ -1117,7 +1285,8 @@ double State::transition_column_crp_alpha()
     double crp_score_0 = get_column_crp_score();
     vector<double> unorm_logps = calc_column_crp_marginals(column_crp_alpha_grid);
     double rand_u = draw_rand_u();
-    int draw = numerics::draw_sample_unnormalized(unorm_logps, rand_u);
+    int draw = numerics::draw_sample_unnormalized(unorm_logps, rand_u,
+        sample_buffer);
     column_crp_alpha = column_crp_alpha_grid[draw];
     column_crp_score = unorm_logps[draw];
     double crp_score_delta = column_crp_score - crp_score_0;
@@ -1154,12 +1323,12 @@ void State::decrement_num_cols_effective()
     num_cols_effective--;
 }
 
-void State::construct_base_hyper_grids(const MatrixD &data, int N_GRID,
+void State::construct_base_hyper_grids(int N_GRID,
     vector<double> ROW_CRP_ALPHA_GRID,
     vector<double> COLUMN_CRP_ALPHA_GRID)
 {
-    int num_rows = data.size1();
-    int num_cols = data.size2();
+    int num_rows = p_data_store->get_num_rows();
+    int num_cols = p_data_store->get_num_cols();
     if (ROW_CRP_ALPHA_GRID.size() == 0) {
         ROW_CRP_ALPHA_GRID = create_crp_alpha_grid(num_rows, N_GRID);
     }
@@ -1174,8 +1343,7 @@ void State::construct_base_hyper_grids(const MatrixD &data, int N_GRID,
         multinomial_alpha_grid);
 }
 
-void State::construct_column_hyper_grids(const MatrixD &data,
-    const vector<int> &global_col_indices,
+void State::construct_column_hyper_grids(const vector<int> &global_col_indices,
     const vector<string> &GLOBAL_COL_DATATYPES,
     const vector<double> &S_GRID,
     const vector<double> &MU_GRID)
@@ -1188,7 +1356,7 @@ void State::construct_column_hyper_grids(const MatrixD &data,
         if (col_datatype == CONTINUOUS_DATATYPE) {
             if (S_GRID.size() == 0) {
                 // FIXME: enable separate setting of S_GRID, MU_GRID
-                vector<double> col_data = extract_col(data, global_col_idx);
+                vector<double> col_data = p_data_store->get_column(global_col_idx);
                 construct_continuous_specific_hyper_grid(N_GRID, col_data,
                     s_grids[global_col_idx],
                     mu_grids[global_col_idx]);
@@ -1197,7 +1365,7 @@ void State::construct_column_hyper_grids(const MatrixD &data,
                 mu_grids[global_col_idx] = MU_GRID;
             }
         } else if (col_datatype == CYCLIC_DATATYPE) {
-            vector<double> col_data = extract_col(data, global_col_idx);
+            vector<double> col_data = p_data_store->get_column(global_col_idx);
             construct_cyclic_specific_hyper_grid(N_GRID, col_data,
                 vm_a_grids[global_col_idx],
                 vm_kappa_grids[global_col_idx]);
@@ -1304,12 +1472,59 @@ void State::init_column_hypers(const vector<int> &global_col_indices)
     }
 }
 
-void State::init_views(const MatrixD &data,
+void State::init_from_prior(const vector<string> &GLOBAL_COL_DATATYPES,
+    const vector<int> &GLOBAL_COL_MULTINOMIAL_COUNTS,
     const vector<int> &global_row_indices,
+    const vector<int> &global_col_indices,
+    const string &col_initialization,
+    string row_initialization,
+    const vector<double> &ROW_CRP_ALPHA_GRID,
+    const vector<double> &COLUMN_CRP_ALPHA_GRID,
+    const vector<double> &S_GRID,
+    const vector<double> &MU_GRID,
+    int N_GRID, int CT_KERNEL)
+{
+    assert(CT_KERNEL == 1 || CT_KERNEL == 0);
+    ct_kernel = CT_KERNEL;
+    column_crp_score = 0;
+    data_score = 0;
+    sum_log_gamma_view_counts = 0;
+    num_assigned_cols = 0;
+    if (row_initialization == "") {
+        row_initialization = col_initialization;
+    }
+    num_cols_effective = global_col_indices.size();
+    global_col_datatypes = construct_lookup_map(global_col_indices,
+            GLOBAL_COL_DATATYPES);
+    global_col_multinomial_counts = construct_lookup_map(global_col_indices,
+            GLOBAL_COL_MULTINOMIAL_COUNTS);
+    // construct grids
+    construct_base_hyper_grids(N_GRID, ROW_CRP_ALPHA_GRID,
+        COLUMN_CRP_ALPHA_GRID);
+    construct_column_hyper_grids(global_col_indices, GLOBAL_COL_DATATYPES,
+        S_GRID, MU_GRID);
+    //
+    init_column_hypers(global_col_indices);
+    column_crp_alpha = sample_column_crp_alpha();
+    vector<vector<int> > column_partition = generate_col_partition(
+            global_col_indices,
+            col_initialization);
+    vector<double> row_crp_alpha_v = sample_row_crp_alphas(
+            column_partition.size());
+    vector<vector<vector<int> > > row_partition_v = generate_row_partitions(
+            global_row_indices,
+            row_crp_alpha_v, row_initialization);
+    init_views(global_row_indices, global_col_indices,
+        column_partition, row_partition_v,
+        row_crp_alpha_v);
+}
+
+void State::init_views(const vector<int> &global_row_indices,
     const vector<int> &global_col_indices,
     const vector<vector<int> > &column_partition,
     const vector<vector<vector<int> > > &row_partition_v,
-    const vector<double> &row_crp_alpha_v)
+    const vector<double> &row_crp_alpha_v,
+    const vector<vector<double> > *p_view_suffstats)
 {
     assert(column_partition.size() == row_partition_v.size());
     assert(column_partition.size() == row_crp_alpha_v.size());
@@ -1320,11 +1535,25 @@ void State::init_views(const MatrixD &data,
             column_indices, get_column_dependencies());
         vector<vector<int> > row_partition = row_partition_v[view_idx];
         double row_crp_alpha = row_crp_alpha_v[view_idx];
-        const MatrixD data_subset = extract_columns(data, column_indices);
+        // the view's columns, read from the store, unless they're inserted
+        // from saved suffstats below
+        vector<int> data_col_indices;
+        if (p_view_suffstats == NULL) {
+            data_col_indices = column_indices;
+        }
+        int num_rows = p_data_store->get_num_rows();
+        int num_data_cols = data_col_indices.size();
+        MatrixD data_subset(num_rows, num_data_cols);
+        for (int col_idx = 0; col_idx < num_data_cols; col_idx++) {
+            for (int row_idx = 0; row_idx < num_rows; row_idx++) {
+                data_subset(row_idx, col_idx) = p_data_store->get_value(
+                        row_idx, data_col_indices[col_idx]);
+            }
+        }
         View *p_v = new View(data_subset,
             global_col_datatypes,
             row_partition,
-            global_row_indices, column_indices,
+            global_row_indices, data_col_indices,
             num_cols_effective,
             hypers_m,
             row_crp_alpha_grid,
@@ -1334,13 +1563,371 @@ void State::init_views(const MatrixD &data,
             vm_a_grids, vm_kappa_grids,
             row_crp_alpha,
             draw_rand_i());
+        p_v->set_data_store(*p_data_store);
         views.push_back(p_v);
+        if (p_view_suffstats != NULL) {
+            insert_saved_suffstats(*p_v, column_indices,
+                (*p_view_suffstats)[view_idx]);
+        }
+        sum_log_gamma_view_counts += numerics::log_gamma(column_indices.size());
         vector<int>::const_iterator ci_it;
         for (ci_it = column_indices.begin(); ci_it != column_indices.end(); ++ci_it) {
             int column_index = *ci_it;
+            if (column_index >= (int) view_lookup.size()) {
+                view_lookup.resize(column_index + 1, NULL);
+            }
             view_lookup[column_index] = p_v;
+            num_assigned_cols++;
+        }
+    }
+}
+
+void State::save_snapshot(const string &filename) const
+{
+    SnapshotWriter writer(filename);
+    int num_rows = p_data_store->get_num_rows();
+    int num_cols = p_data_store->get_num_cols();
+    writer.write_int(num_rows);
+    writer.write_int(num_cols);
+    writer.write_int(ct_kernel);
+    vector<int> multinomial_counts;
+    for (int col_idx = 0; col_idx < num_cols; col_idx++) {
+        writer.write_string(get(global_col_datatypes, col_idx));
+        multinomial_counts.push_back(get(global_col_multinomial_counts,
+                col_idx));
+    }
+    writer.write_ints(multinomial_counts);
+    writer.write_double(column_crp_alpha);
+    // grids
+    writer.write_doubles(row_crp_alpha_grid);
+    writer.write_doubles(column_crp_alpha_grid);
+    writer.write_doubles(multinomial_alpha_grid);
+    writer.write_doubles(r_grid);
+    writer.write_doubles(nu_grid);
+    writer.write_doubles(vm_b_grid);
+    for (int col_idx = 0; col_idx < num_cols; col_idx++) {
+        const string &col_datatype = get(global_col_datatypes, col_idx);
+        if (col_datatype == CONTINUOUS_DATATYPE) {
+            writer.write_doubles(get(s_grids, col_idx));
+            writer.write_doubles(get(mu_grids, col_idx));
+        } else if (col_datatype == CYCLIC_DATATYPE) {
+            writer.write_doubles(get(vm_a_grids, col_idx));
+            writer.write_doubles(get(vm_kappa_grids, col_idx));
+        }
+    }
+    // hypers and column constraints
+    for (int col_idx = 0; col_idx < num_cols; col_idx++) {
+        const CM_Hypers &hypers = get(hypers_m, col_idx);
+        writer.write_int(hypers.size());
+        CM_Hypers::const_iterator it;
+        for (it = hypers.begin(); it != hypers.end(); ++it) {
+            writer.write_string(it->first);
+            writer.write_double(it->second);
+        }
+    }
+    const map<int, set<int> > *constraints[] = {&column_dependencies,
+        &column_independencies};
+    for (int i = 0; i < 2; i++) {
+        writer.write_int(constraints[i]->size());
+        map<int, set<int> >::const_iterator it;
+        for (it = constraints[i]->begin(); it != constraints[i]->end(); ++it) {
+            writer.write_int(it->first);
+            writer.write_ints(vector<int>(it->second.begin(),
+                    it->second.end()));
+        }
+    }
+    // partitions
+    writer.write_int(views.size());
+    vector<View *>::const_iterator it;
+    for (it = views.begin(); it != views.end(); ++it) {
+        View &v = **it;
+        writer.write_double(v.get_crp_alpha());
+        writer.write_ints(v.get_global_col_indices());
+        vector<int> cluster_of_row(num_rows, -1);
+        vector<vector<int> > cluster_groupings = v.get_cluster_groupings();
+        for (int cluster_idx = 0; cluster_idx < v.get_num_clusters();
+            cluster_idx++) {
+            const vector<int> &row_indices = cluster_groupings[cluster_idx];
+            vector<int>::const_iterator row_it;
+            for (row_it = row_indices.begin(); row_it != row_indices.end();
+                ++row_it) {
+                cluster_of_row[*row_it] = cluster_idx;
+            }
+        }
+        writer.write_ints(cluster_of_row);
+        writer.write_doubles(get_view_suffstats(v));
+    }
+    // generators, so the chain continues where it was
+    vector<string> rng_states = get_rng_states();
+    vector<string>::const_iterator rng_it;
+    for (rng_it = rng_states.begin(); rng_it != rng_states.end(); ++rng_it) {
+        writer.write_string(*rng_it);
+    }
+    writer.close();
+}
+
+void State::load_snapshot(const string &snapshot_filename)
+{
+    SnapshotReader reader(snapshot_filename);
+    int num_rows = reader.read_int();
+    int num_cols = reader.read_int();
+    if (num_rows != p_data_store->get_num_rows()
+        || num_cols != p_data_store->get_num_cols()) {
+        fail_snapshot(snapshot_filename, "is of a " + stringify(num_rows)
+            + " x " + stringify(num_cols) + " table");
+    }
+    ct_kernel = reader.read_int();
+    column_crp_score = 0;
+    data_score = 0;
+    sum_log_gamma_view_counts = 0;
+    num_assigned_cols = 0;
+    vector<int> global_row_indices = create_sequence(num_rows);
+    vector<int> global_col_indices = create_sequence(num_cols);
+    vector<string> GLOBAL_COL_DATATYPES;
+    for (int col_idx = 0; col_idx < num_cols; col_idx++) {
+        string col_datatype = reader.read_string();
+        if (col_datatype != CONTINUOUS_DATATYPE
+            && col_datatype != MULTINOMIAL_DATATYPE
+            && col_datatype != CYCLIC_DATATYPE) {
+            fail_snapshot(snapshot_filename, "has an unknown datatype");
+        }
+        GLOBAL_COL_DATATYPES.push_back(col_datatype);
+    }
+    global_col_datatypes = construct_lookup_map(global_col_indices,
+            GLOBAL_COL_DATATYPES);
+    vector<int> multinomial_counts = reader.read_ints();
+    if ((int) multinomial_counts.size() != num_cols) {
+        fail_snapshot(snapshot_filename, "is corrupt");
+    }
+    global_col_multinomial_counts = construct_lookup_map(global_col_indices,
+            multinomial_counts);
+    column_crp_alpha = reader.read_double();
+    // grids
+    row_crp_alpha_grid = reader.read_doubles();
+    column_crp_alpha_grid = reader.read_doubles();
+    multinomial_alpha_grid = reader.read_doubles();
+    r_grid = reader.read_doubles();
+    nu_grid = reader.read_doubles();
+    vm_b_grid = reader.read_doubles();
+    for (int col_idx = 0; col_idx < num_cols; col_idx++) {
+        const string &col_datatype = GLOBAL_COL_DATATYPES[col_idx];
+        if (col_datatype == CONTINUOUS_DATATYPE) {
+            s_grids[col_idx] = reader.read_doubles();
+            mu_grids[col_idx] = reader.read_doubles();
+        } else if (col_datatype == CYCLIC_DATATYPE) {
+            vm_a_grids[col_idx] = reader.read_doubles();
+            vm_kappa_grids[col_idx] = reader.read_doubles();
+        }
+    }
+    // hypers and column constraints
+    for (int col_idx = 0; col_idx < num_cols; col_idx++) {
+        CM_Hypers &hypers = hypers_m[col_idx];
+        int num_hypers = reader.read_int();
+        for (int hyper_idx = 0; hyper_idx < num_hypers; hyper_idx++) {
+            string hyper_name = reader.read_string();
+            hypers[hyper_name] = reader.read_double();
+        }
+        // the saved suffstats hold K label counts for a multinomial column
+        if (GLOBAL_COL_DATATYPES[col_idx] == MULTINOMIAL_DATATYPE) {
+            int K = multinomial_counts[col_idx];
+            if (K < 1 || hypers.count("K") == 0 || hypers["K"] != K) {
+                fail_snapshot(snapshot_filename, "is corrupt");
+            }
+        }
+    }
+    map<int, set<int> > *constraints[] = {&column_dependencies,
+        &column_independencies};
+    for (int i = 0; i < 2; i++) {
+        int num_constrained = reader.read_int();
+        for (int j = 0; j < num_constrained; j++) {
+            int col_idx = reader.read_int();
+            vector<int> others = reader.read_ints();
+            (*constraints[i])[col_idx] = set<int>(others.begin(),
+                    others.end());
+        }
+    }
+    num_cols_effective = get_vector_num_blocks(
+        global_col_indices, column_dependencies);
+    // partitions and suffstats: a view's clusters are restored from the
+    // saved suffstats, without reading the data
+    int num_views = reader.read_int();
+    vector<vector<int> > column_partition;
+    vector<vector<vector<int> > > row_partition_v;
+    vector<double> row_crp_alpha_v;
+    vector<vector<double> > view_suffstats;
+    vector<bool> col_seen(num_cols, false);
+    for (int view_idx = 0; view_idx < num_views; view_idx++) {
+        row_crp_alpha_v.push_back(reader.read_double());
+        vector<int> column_indices = reader.read_ints();
+        size_t cluster_num_suffstats = 0;
+        vector<int>::const_iterator it;
+        for (it = column_indices.begin(); it != column_indices.end(); ++it) {
+            if (*it < 0 || *it >= num_cols || col_seen[*it]) {
+                fail_snapshot(snapshot_filename, "is corrupt");
+            }
+            col_seen[*it] = true;
+            cluster_num_suffstats += get_num_saved_suffstats(*it);
+        }
+        column_partition.push_back(column_indices);
+        vector<int> cluster_of_row = reader.read_ints();
+        if ((int) cluster_of_row.size() != num_rows) {
+            fail_snapshot(snapshot_filename, "is corrupt");
+        }
+        vector<vector<int> > row_partition;
+        for (int row_idx = 0; row_idx < num_rows; row_idx++) {
+            int cluster_idx = cluster_of_row[row_idx];
+            if (cluster_idx < 0 || cluster_idx >= num_rows) {
+                fail_snapshot(snapshot_filename, "is corrupt");
+            }
+            if (cluster_idx >= (int) row_partition.size()) {
+                row_partition.resize(cluster_idx + 1);
+            }
+            row_partition[cluster_idx].push_back(row_idx);
+        }
+        vector<vector<int> >::const_iterator cluster_it;
+        for (cluster_it = row_partition.begin();
+            cluster_it != row_partition.end(); ++cluster_it) {
+            if (cluster_it->empty()) {
+                fail_snapshot(snapshot_filename, "is corrupt");
+            }
+        }
+        row_partition_v.push_back(row_partition);
+        view_suffstats.push_back(reader.read_doubles());
+        if (view_suffstats.back().size()
+            != row_partition.size() * cluster_num_suffstats) {
+            fail_snapshot(snapshot_filename, "is corrupt");
+        }
+    }
+    if (std::count(col_seen.begin(), col_seen.end(), false) != 0) {
+        fail_snapshot(snapshot_filename, "is corrupt");
+    }
+    init_views(global_row_indices, global_col_indices,
+        column_partition, row_partition_v, row_crp_alpha_v,
+        &view_suffstats);
+    // comparing the loaded counts with the data costs as much as building
+    // the state from the data, so only debug builds check
+    for (int view_idx = 0; view_idx < num_views; view_idx++) {
+        assert(view_counts_match_data(*views[view_idx]));
+    }
+    vector<string> rng_states;
+    for (int i = 0; i < num_views + 1; i++) {
+        rng_states.push_back(reader.read_string());
+    }
+    set_rng_states(rng_states);
+}
+
+void State::fail_snapshot(const string &snapshot_filename,
+    const string &reason) const
+{
+    throw runtime_error("State: snapshot " + snapshot_filename + " "
+        + reason);
+}
+
+void State::insert_saved_suffstats(View &v, const vector<int> &column_indices,
+    const vector<double> &suffstats)
+{
+    int num_clusters = v.get_num_clusters();
+    size_t cluster_num_suffstats =
+        num_clusters == 0 ? 0 : suffstats.size() / num_clusters;
+    size_t col_offset = 0;
+    vector<int>::const_iterator it;
+    for (it = column_indices.begin(); it != column_indices.end(); ++it) {
+        vector<const double *> cluster_suffstats(num_clusters);
+        for (int cluster_idx = 0; cluster_idx < num_clusters; cluster_idx++) {
+            cluster_suffstats[cluster_idx] =
+                &suffstats[cluster_idx * cluster_num_suffstats + col_offset];
+        }
+        v.insert_col_suffstats(cluster_suffstats, *it, hypers_m[*it]);
+        col_offset += get_num_saved_suffstats(*it);
+    }
+    assert(num_clusters == 0 || col_offset == cluster_num_suffstats);
+}
+
+bool State::view_counts_match_data(View &v) const
+{
+    vector<double> suffstats = get_view_suffstats(v);
+    vector<int> global_col_indices = v.get_global_col_indices();
+    vector<vector<int> > cluster_groupings = v.get_cluster_groupings();
+    size_t offset = 0;
+    for (size_t cluster_idx = 0; cluster_idx < cluster_groupings.size();
+        cluster_idx++) {
+        const vector<int> &row_indices = cluster_groupings[cluster_idx];
+        vector<int>::const_iterator col_it;
+        for (col_it = global_col_indices.begin();
+            col_it != global_col_indices.end(); ++col_it) {
+            int num_saved = get_num_saved_suffstats(*col_it);
+            bool is_multinomial = get(global_col_datatypes, *col_it)
+                == MULTINOMIAL_DATATYPE;
+            vector<double> counts(is_multinomial ? num_saved : 1, 0);
+            vector<int>::const_iterator row_it;
+            for (row_it = row_indices.begin(); row_it != row_indices.end();
+                ++row_it) {
+                double value = p_data_store->get_value(*row_it, *col_it);
+                if (isnan(value)) {
+                    continue;
+                }
+                counts[0] += 1;
+                if (is_multinomial) {
+                    int label = (int) value;
+                    if (label < 0 || label >= num_saved - 1) {
+                        return false;
+                    }
+                    counts[1 + label] += 1;
+                }
+            }
+            for (size_t i = 0; i < counts.size(); i++) {
+                if (counts[i] != suffstats[offset + i]) {
+                    return false;
+                }
+            }
+            offset += num_saved;
+        }
+    }
+    return true;
+}
+
+int State::get_num_saved_suffstats(int global_col_idx) const
+{
+    if (get(global_col_datatypes, global_col_idx) == MULTINOMIAL_DATATYPE) {
+        return 1 + get(global_col_multinomial_counts, global_col_idx);
+    }
+    return 3;
+}
+
+vector<double> State::get_view_suffstats(View &v) const
+{
+    vector<double> suffstats;
+    vector<int> global_col_indices = v.get_global_col_indices();
+    int num_cols = global_col_indices.size();
+    vector<Cluster *>::const_iterator it;
+    for (it = v.clusters.begin(); it != v.clusters.end(); ++it) {
+        Cluster &c = **it;
+        for (int local_col_idx = 0; local_col_idx < num_cols; local_col_idx++) {
+            int global_col_idx = global_col_indices[local_col_idx];
+            const string &col_datatype = get(global_col_datatypes,
+                    global_col_idx);
+            map<string, double> cluster_suffstats = c.get_suffstats_i(
+                    local_col_idx);
+            suffstats.push_back(get(cluster_suffstats, string("N")));
+            if (col_datatype == CONTINUOUS_DATATYPE) {
+                suffstats.push_back(get(cluster_suffstats, string("sum_x")));
+                suffstats.push_back(get(cluster_suffstats,
+                        string("sum_x_squared")));
+            } else if (col_datatype == CYCLIC_DATATYPE) {
+                suffstats.push_back(get(cluster_suffstats,
+                        string("sum_sin_x")));
+                suffstats.push_back(get(cluster_suffstats,
+                        string("sum_cos_x")));
+            } else {
+                int K = get(global_col_multinomial_counts, global_col_idx);
+                for (int key = 0; key < K; key++) {
+                    suffstats.push_back(get(cluster_suffstats,
+                            stringify(key)));
+                }
+            }
         }
     }
+    return suffstats;
 }
 
 std::ostream &operator<<(std::ostream &os, const State &s)
@@ -0,0 +1,413 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Lead Developers: Dan Lovell and Jay Baxter
+*   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+*   Research Leads: Vikash Mansinghka, Patrick Shafto
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+#include "constants.h"
+#include "numerics.h"
+#include "Hypers.h"
+#include "SuffstatTable.h"
+
+using namespace std;
+
+SuffstatTable::SuffstatTable() : num_clusters(0)
+{
+}
+
+int SuffstatTable::get_num_clusters() const
+{
+    return num_clusters;
+}
+
+int SuffstatTable::get_num_cols() const
+{
+    return columns.size();
+}
+
+void SuffstatTable::calc_row_predictive_logps(const vector<double> &vd,
+    vector<double> &data_logps) const
+{
+    // one slot per cluster plus one for a new, empty cluster
+    data_logps.assign(num_clusters + 1, 0);
+    int num_cols = vd.size();
+    for (int col_idx = 0; col_idx < num_cols; col_idx++) {
+        double el = vd[col_idx];
+        if (isnan(el)) {
+            continue;
+        }
+        const Column &column = columns[col_idx];
+        if (column.datatype == CONTINUOUS) {
+            numerics::add_continuous_predictive_logps(el, num_clusters + 1,
+                &column.pred_mu[0], &column.pred_s[0], &column.pred_weight[0],
+                &column.pred_half_nu[0], &column.pred_base[0],
+                &data_logps[0]);
+        } else if (column.datatype == CYCLIC) {
+            for (int cluster_idx = 0; cluster_idx < num_clusters;
+                cluster_idx++) {
+                data_logps[cluster_idx] += numerics::calc_cyclic_data_logp(
+                        column.count[cluster_idx], column.sum_0[cluster_idx],
+                        column.sum_1[cluster_idx], column.hyper_0,
+                        column.hyper_1, column.hyper_2, el);
+            }
+            // the empty cluster's posterior a after seeing el
+            double p_cos = column.hyper_0 * cos(el) + column.empty_0;
+            double p_sin = column.hyper_0 * sin(el) + column.empty_1;
+            double am = sqrt(p_cos * p_cos + p_sin * p_sin);
+            data_logps[num_clusters] += column.empty_2
+                + (numerics::calc_cyclic_log_Z(am) - column.empty_3);
+        } else {
+            assert(0 <= el && el < column.K && el == trunc(el));
+            int i = static_cast<int>(el);
+            int K = column.K;
+            double dirichlet_alpha = column.hyper_0;
+            for (int cluster_idx = 0; cluster_idx < num_clusters;
+                cluster_idx++) {
+                int count = column.count[cluster_idx];
+                int label_count = column.label_counts[cluster_idx * K + i];
+                double numerator = dirichlet_alpha + label_count;
+                double denominator = count + K * dirichlet_alpha;
+                data_logps[cluster_idx] += log(numerator) - log(denominator);
+            }
+            data_logps[num_clusters] += column.empty_0;
+        }
+    }
+}
+
+vector<double> SuffstatTable::calc_dirichlet_alpha_conditionals(int col_idx,
+    const vector<double> &dirichlet_alpha_grid,
+    LgammaTable &lgamma_table) const
+{
+    const Column &column = columns[col_idx];
+    assert(column.datatype == MULTINOMIAL);
+    assert(num_clusters > 0);
+    int K = column.K;
+    int num_grid = dirichlet_alpha_grid.size();
+    vector<double> logps;
+    vector<int> counts(K);
+    for (int cluster_idx = 0; cluster_idx < num_clusters; cluster_idx++) {
+        vector<int>::const_iterator labels_begin = column.label_counts.begin()
+            + cluster_idx * K;
+        std::copy(labels_begin, labels_begin + K, counts.begin());
+        vector<double> cluster_logps =
+            numerics::calc_multinomial_dirichlet_alpha_conditional(
+                dirichlet_alpha_grid, column.count[cluster_idx], counts, K,
+                lgamma_table);
+        if (cluster_idx == 0) {
+            logps = cluster_logps;
+            continue;
+        }
+        for (int grid_idx = 0; grid_idx < num_grid; grid_idx++) {
+            logps[grid_idx] += cluster_logps[grid_idx];
+        }
+    }
+    return logps;
+}
+
+vector<double> SuffstatTable::calc_continuous_hyper_conditionals(int col_idx,
+    HyperId which_hyper, const vector<double> &hyper_grid) const
+{
+    const Column &column = columns[col_idx];
+    assert(column.datatype == CONTINUOUS);
+    assert(num_clusters > 0);
+    return numerics::calc_continuous_hyper_conditionals(which_hyper,
+            hyper_grid, num_clusters, &column.count[0],
+            &column.sum_0[0], &column.sum_1[0],
+            column.hyper_0, column.hyper_1, column.hyper_2, column.hyper_3);
+}
+
+void SuffstatTable::insert_cluster()
+{
+    vector<Column>::iterator it;
+    for (it = columns.begin(); it != columns.end(); ++it) {
+        Column &column = *it;
+        column.count.push_back(0);
+        column.sum_0.push_back(0);
+        column.sum_1.push_back(0);
+        column.score.push_back(0);
+        column.label_counts.resize(column.label_counts.size() + column.K, 0);
+        if (column.datatype == CONTINUOUS) {
+            // the new cluster takes a copy of the trailing empty slot
+            column.pred_mu.push_back(column.pred_mu.back());
+            column.pred_s.push_back(column.pred_s.back());
+            column.pred_weight.push_back(column.pred_weight.back());
+            column.pred_half_nu.push_back(column.pred_half_nu.back());
+            column.pred_base.push_back(column.pred_base.back());
+        }
+    }
+    num_clusters++;
+}
+
+void SuffstatTable::remove_cluster(int cluster_idx)
+{
+    assert(0 <= cluster_idx && cluster_idx < num_clusters);
+    vector<Column>::iterator it;
+    for (it = columns.begin(); it != columns.end(); ++it) {
+        Column &column = *it;
+        column.count.erase(column.count.begin() + cluster_idx);
+        column.sum_0.erase(column.sum_0.begin() + cluster_idx);
+        column.sum_1.erase(column.sum_1.begin() + cluster_idx);
+        column.score.erase(column.score.begin() + cluster_idx);
+        vector<int>::iterator labels_begin = column.label_counts.begin()
+            + cluster_idx * column.K;
+        column.label_counts.erase(labels_begin, labels_begin + column.K);
+        if (column.datatype == CONTINUOUS) {
+            column.pred_mu.erase(column.pred_mu.begin() + cluster_idx);
+            column.pred_s.erase(column.pred_s.begin() + cluster_idx);
+            column.pred_weight.erase(column.pred_weight.begin() + cluster_idx);
+            column.pred_half_nu.erase(column.pred_half_nu.begin()
+                + cluster_idx);
+            column.pred_base.erase(column.pred_base.begin() + cluster_idx);
+        }
+    }
+    num_clusters--;
+}
+
+void SuffstatTable::insert_col(const string &col_datatype,
+    const CM_Hypers &hypers)
+{
+    Column column;
+    if (col_datatype == CONTINUOUS_DATATYPE) {
+        column.datatype = CONTINUOUS;
+    } else if (col_datatype == CYCLIC_DATATYPE) {
+        column.datatype = CYCLIC;
+    } else if (col_datatype == MULTINOMIAL_DATATYPE) {
+        column.datatype = MULTINOMIAL;
+    } else {
+        cout << "SuffstatTable::insert_col: col_datatype=" << col_datatype
+            << endl;
+        assert(1 == 0);
+        exit(EXIT_FAILURE);
+    }
+    column.p_hypers = &hypers;
+    column.K = 0;
+    read_hypers(column);
+    column.count.resize(num_clusters, 0);
+    column.sum_0.resize(num_clusters, 0);
+    column.sum_1.resize(num_clusters, 0);
+    column.score.resize(num_clusters, 0);
+    column.label_counts.resize(num_clusters * column.K, 0);
+    if (column.datatype == CONTINUOUS) {
+        column.pred_mu.resize(num_clusters + 1);
+        column.pred_s.resize(num_clusters + 1);
+        column.pred_weight.resize(num_clusters + 1);
+        column.pred_half_nu.resize(num_clusters + 1);
+        column.pred_base.resize(num_clusters + 1);
+        for (int cluster_idx = 0; cluster_idx <= num_clusters; cluster_idx++) {
+            refresh_predictive_terms(column, cluster_idx);
+        }
+    }
+    columns.push_back(column);
+}
+
+void SuffstatTable::Column::swap(Column &other)
+{
+    std::swap(datatype, other.datatype);
+    std::swap(p_hypers, other.p_hypers);
+    std::swap(hyper_0, other.hyper_0);
+    std::swap(hyper_1, other.hyper_1);
+    std::swap(hyper_2, other.hyper_2);
+    std::swap(hyper_3, other.hyper_3);
+    std::swap(log_Z_0, other.log_Z_0);
+    std::swap(K, other.K);
+    std::swap(empty_0, other.empty_0);
+    std::swap(empty_1, other.empty_1);
+    std::swap(empty_2, other.empty_2);
+    std::swap(empty_3, other.empty_3);
+    count.swap(other.count);
+    sum_0.swap(other.sum_0);
+    sum_1.swap(other.sum_1);
+    score.swap(other.score);
+    label_counts.swap(other.label_counts);
+    pred_mu.swap(other.pred_mu);
+    pred_s.swap(other.pred_s);
+    pred_weight.swap(other.pred_weight);
+    pred_half_nu.swap(other.pred_half_nu);
+    pred_base.swap(other.pred_base);
+}
+
+void SuffstatTable::remove_col(int col_idx)
+{
+    if (col_idx != (int) columns.size() - 1) {
+        columns[col_idx].swap(columns.back());
+    }
+    columns.pop_back();
+}
+
+void SuffstatTable::insert_element(int cluster_idx, int col_idx,
+    double element)
+{
+    Column &column = columns[col_idx];
+    if (update_element(column, cluster_idx, element, 1)) {
+        refresh_score(column, cluster_idx);
+    }
+}
+
+void SuffstatTable::set_suffstats(int cluster_idx, int col_idx,
+    const double *suffstats)
+{
+    Column &column = columns[col_idx];
+    column.count[cluster_idx] = static_cast<int>(suffstats[0]);
+    if (column.datatype == MULTINOMIAL) {
+        int *label_counts = &column.label_counts[cluster_idx * column.K];
+        for (int i = 0; i < column.K; i++) {
+            label_counts[i] = static_cast<int>(suffstats[1 + i]);
+        }
+    } else {
+        column.sum_0[cluster_idx] = suffstats[1];
+        column.sum_1[cluster_idx] = suffstats[2];
+    }
+    refresh_score(column, cluster_idx);
+}
+
+void SuffstatTable::insert_row(int cluster_idx, const vector<double> &vd)
+{
+    int num_cols = vd.size();
+    for (int col_idx = 0; col_idx < num_cols; col_idx++) {
+        Column &column = columns[col_idx];
+        if (update_element(column, cluster_idx, vd[col_idx], 1)) {
+            refresh_score(column, cluster_idx);
+        }
+    }
+}
+
+void SuffstatTable::remove_row(int cluster_idx, const vector<double> &vd)
+{
+    int num_cols = vd.size();
+    for (int col_idx = 0; col_idx < num_cols; col_idx++) {
+        Column &column = columns[col_idx];
+        if (update_element(column, cluster_idx, vd[col_idx], -1)) {
+            refresh_score(column, cluster_idx);
+        }
+    }
+}
+
+void SuffstatTable::incorporate_hyper_update(int col_idx)
+{
+    Column &column = columns[col_idx];
+    read_hypers(column);
+    for (int cluster_idx = 0; cluster_idx < num_clusters; cluster_idx++) {
+        refresh_score(column, cluster_idx);
+    }
+    if (column.datatype == CONTINUOUS) {
+        refresh_predictive_terms(column, num_clusters);
+    }
+}
+
+void SuffstatTable::read_hypers(Column &column)
+{
+    const CM_Hypers &hypers = *column.p_hypers;
+    column.log_Z_0 = 0;
+    if (column.datatype == CONTINUOUS) {
+        column.hyper_0 = get(hypers, get_hyper_name(HYPER_R));
+        column.hyper_1 = get(hypers, get_hyper_name(HYPER_NU));
+        column.hyper_2 = get(hypers, get_hyper_name(HYPER_S));
+        column.hyper_3 = get(hypers, get_hyper_name(HYPER_MU));
+        column.log_Z_0 = numerics::calc_continuous_logp(0, column.hyper_0,
+                column.hyper_1, column.hyper_2, 0);
+    } else if (column.datatype == CYCLIC) {
+        column.hyper_0 = get(hypers, get_hyper_name(HYPER_KAPPA));
+        column.hyper_1 = get(hypers, get_hyper_name(HYPER_A));
+        column.hyper_2 = get(hypers, get_hyper_name(HYPER_B));
+        // numerics::calc_cyclic_data_logp at count 0, term for term
+        double kappa = column.hyper_0;
+        double an = column.hyper_1;
+        double bn = column.hyper_2;
+        numerics::update_cyclic_hypers(0, 0, 0, kappa, an, bn);
+        column.empty_0 = column.hyper_1 * cos(column.hyper_2);
+        column.empty_1 = column.hyper_1 * sin(column.hyper_2);
+        column.empty_2 = -LOG_2PI - numerics::log_bessel_0(kappa);
+        column.empty_3 = numerics::calc_cyclic_log_Z(an);
+    } else {
+        column.hyper_0 = get(hypers, get_hyper_name(HYPER_DIRICHLET_ALPHA));
+        int K = get(hypers, get_hyper_name(HYPER_K));
+        // K is fixed once the column has data
+        assert(column.K == 0 || column.K == K);
+        column.K = K;
+        double dirichlet_alpha = column.hyper_0;
+        column.empty_0 = log(dirichlet_alpha) - log(K * dirichlet_alpha);
+    }
+}
+
+void SuffstatTable::refresh_score(Column &column, int cluster_idx)
+{
+    if (column.datatype != CONTINUOUS) {
+        return;
+    }
+    int count = column.count[cluster_idx];
+    double r = column.hyper_0;
+    double nu = column.hyper_1;
+    double s = column.hyper_2;
+    double mu = column.hyper_3;
+    numerics::update_continuous_hypers(count, column.sum_0[cluster_idx],
+        column.sum_1[cluster_idx], r, nu, s, mu);
+    column.score[cluster_idx] = numerics::calc_continuous_logp(count, r, nu, s,
+            column.log_Z_0);
+    refresh_predictive_terms(column, cluster_idx);
+}
+
+void SuffstatTable::refresh_predictive_terms(Column &column, int cluster_idx)
+{
+    bool is_empty = cluster_idx == num_clusters;
+    numerics::calc_continuous_predictive_terms(
+        is_empty ? 0 : column.count[cluster_idx],
+        is_empty ? 0 : column.sum_0[cluster_idx],
+        is_empty ? 0 : column.sum_1[cluster_idx],
+        column.hyper_0, column.hyper_1, column.hyper_2, column.hyper_3,
+        column.log_Z_0,
+        is_empty ? 0 : column.score[cluster_idx],
+        column.pred_mu[cluster_idx], column.pred_s[cluster_idx],
+        column.pred_weight[cluster_idx], column.pred_half_nu[cluster_idx],
+        column.pred_base[cluster_idx]);
+}
+
+bool SuffstatTable::update_element(Column &column, int cluster_idx,
+    double element, int sign)
+{
+    if (isnan(element)) {
+        return false;
+    }
+    int &count = column.count[cluster_idx];
+    double &sum_0 = column.sum_0[cluster_idx];
+    double &sum_1 = column.sum_1[cluster_idx];
+    if (column.datatype == CONTINUOUS) {
+        if (sign > 0) {
+            numerics::insert_to_continuous_suffstats(count, sum_0, sum_1,
+                element);
+        } else {
+            numerics::remove_from_continuous_suffstats(count, sum_0, sum_1,
+                element);
+        }
+    } else if (column.datatype == CYCLIC) {
+        if (sign > 0) {
+            numerics::insert_to_cyclic_suffstats(count, sum_0, sum_1, element);
+        } else {
+            numerics::remove_from_cyclic_suffstats(count, sum_0, sum_1,
+                element);
+        }
+    } else {
+        int i = static_cast<int>(element);
+        assert(0 <= i && i < column.K);
+        column.label_counts[cluster_idx * column.K + i] += sign;
+        count += sign;
+    }
+    return true;
+}
@@ -0,0 +1,114 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Lead Developers: Dan Lovell and Jay Baxter
+*   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+*   Research Leads: Vikash Mansinghka, Patrick Shafto
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+#include "constants.h"
+#include "numerics.h"
+#include "Suffstats.h"
+
+using namespace std;
+
+Suffstats::Suffstats(const string &col_datatype, const CM_Hypers &hypers) :
+    hyper_0(0), hyper_1(0), hyper_2(0), hyper_3(0), log_Z_0(0), count(0),
+    sum_0(0), sum_1(0)
+{
+    if (col_datatype == CONTINUOUS_DATATYPE) {
+        datatype = CONTINUOUS;
+        hyper_0 = get(hypers, get_hyper_name(HYPER_R));
+        hyper_1 = get(hypers, get_hyper_name(HYPER_NU));
+        hyper_2 = get(hypers, get_hyper_name(HYPER_S));
+        hyper_3 = get(hypers, get_hyper_name(HYPER_MU));
+        log_Z_0 = numerics::calc_continuous_logp(0, hyper_0, hyper_1,
+                hyper_2, 0);
+    } else if (col_datatype == CYCLIC_DATATYPE) {
+        datatype = CYCLIC;
+        hyper_0 = get(hypers, get_hyper_name(HYPER_KAPPA));
+        hyper_1 = get(hypers, get_hyper_name(HYPER_A));
+        hyper_2 = get(hypers, get_hyper_name(HYPER_B));
+        log_Z_0 = numerics::calc_cyclic_log_Z(hyper_1);
+    } else if (col_datatype == MULTINOMIAL_DATATYPE) {
+        datatype = MULTINOMIAL;
+        hyper_0 = get(hypers, get_hyper_name(HYPER_DIRICHLET_ALPHA));
+        counts.resize((int) get(hypers, get_hyper_name(HYPER_K)));
+    } else {
+        cout << "Suffstats::Suffstats: col_datatype=" << col_datatype << endl;
+        assert(1 == 0);
+        exit(EXIT_FAILURE);
+    }
+}
+
+double Suffstats::calc_marginal_logp() const
+{
+    if (datatype == CONTINUOUS) {
+        double r = hyper_0;
+        double nu = hyper_1;
+        double s = hyper_2;
+        double mu = hyper_3;
+        numerics::update_continuous_hypers(count, sum_0, sum_1, r, nu, s, mu);
+        return numerics::calc_continuous_logp(count, r, nu, s, log_Z_0);
+    } else if (datatype == CYCLIC) {
+        double kappa = hyper_0;
+        double a = hyper_1;
+        double b = hyper_2;
+        numerics::update_cyclic_hypers(count, sum_0, sum_1, kappa, a, b);
+        return numerics::calc_cyclic_logp(count, kappa, a, log_Z_0);
+    } else {
+        int K = counts.size();
+        return numerics::calc_multinomial_marginal_logp(count, counts, K,
+                hyper_0);
+    }
+}
+
+void Suffstats::insert_element(double element)
+{
+    if (isnan(element)) {
+        return;
+    }
+    if (datatype == CONTINUOUS) {
+        numerics::insert_to_continuous_suffstats(count, sum_0, sum_1, element);
+    } else if (datatype == CYCLIC) {
+        numerics::insert_to_cyclic_suffstats(count, sum_0, sum_1, element);
+    } else {
+        int i = static_cast<int>(element);
+        assert(0 <= i && i < (int) counts.size());
+        counts[i] += 1;
+        count += 1;
+    }
+}
+
+void Suffstats::remove_element(double element)
+{
+    if (isnan(element)) {
+        return;
+    }
+    if (datatype == CONTINUOUS) {
+        numerics::remove_from_continuous_suffstats(count, sum_0, sum_1,
+            element);
+    } else if (datatype == CYCLIC) {
+        numerics::remove_from_cyclic_suffstats(count, sum_0, sum_1, element);
+    } else {
+        int i = static_cast<int>(element);
+        assert(0 < counts[i]);
+        counts[i] -= 1;
+        count -= 1;
+    }
+}
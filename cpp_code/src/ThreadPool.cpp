@@ -0,0 +1,122 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Lead Developers: Dan Lovell and Jay Baxter
+*   Authors: Dan Lovell, Baxter Eaves, Jay Baxter, Vikash Mansinghka
+*   Research Leads: Vikash Mansinghka, Patrick Shafto
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+#include "ThreadPool.h"
+
+using namespace std;
+
+ThreadPool::ThreadPool(int num_threads) : p_task(NULL), num_tasks(0),
+    next_task_idx(0), num_unfinished(0), shutting_down(false)
+{
+    assert(num_threads >= 1);
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&work_available, NULL);
+    pthread_cond_init(&work_done, NULL);
+    for (int thread_idx = 1; thread_idx < num_threads; thread_idx++) {
+        pthread_t worker;
+        if (pthread_create(&worker, NULL, worker_main, this) != 0) {
+            cout << "ThreadPool: failed to create worker thread" << endl;
+            exit(EXIT_FAILURE);
+        }
+        workers.push_back(worker);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    pthread_mutex_lock(&mutex);
+    shutting_down = true;
+    pthread_cond_broadcast(&work_available);
+    pthread_mutex_unlock(&mutex);
+    vector<pthread_t>::iterator it;
+    for (it = workers.begin(); it != workers.end(); ++it) {
+        pthread_join(*it, NULL);
+    }
+    pthread_cond_destroy(&work_done);
+    pthread_cond_destroy(&work_available);
+    pthread_mutex_destroy(&mutex);
+}
+
+int ThreadPool::get_num_threads() const
+{
+    return workers.size() + 1;
+}
+
+void ThreadPool::run(ThreadPoolTask &task, int num_tasks)
+{
+    if (workers.empty() || num_tasks <= 1) {
+        for (int task_idx = 0; task_idx < num_tasks; task_idx++) {
+            task.run(task_idx);
+        }
+        return;
+    }
+    pthread_mutex_lock(&mutex);
+    assert(p_task == NULL);
+    p_task = &task;
+    this->num_tasks = num_tasks;
+    next_task_idx = 0;
+    num_unfinished = num_tasks;
+    pthread_cond_broadcast(&work_available);
+    while (next_task_idx < this->num_tasks) {
+        run_next_task();
+    }
+    while (num_unfinished > 0) {
+        pthread_cond_wait(&work_done, &mutex);
+    }
+    p_task = NULL;
+    pthread_mutex_unlock(&mutex);
+}
+
+void *ThreadPool::worker_main(void *p_pool)
+{
+    static_cast<ThreadPool *>(p_pool)->worker_loop();
+    return NULL;
+}
+
+void ThreadPool::worker_loop()
+{
+    pthread_mutex_lock(&mutex);
+    while (true) {
+        while (!shutting_down
+            && (p_task == NULL || next_task_idx >= num_tasks)) {
+            pthread_cond_wait(&work_available, &mutex);
+        }
+        if (shutting_down) {
+            break;
+        }
+        run_next_task();
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+void ThreadPool::run_next_task()
+{
+    int task_idx = next_task_idx++;
+    ThreadPoolTask *p_current_task = p_task;
+    pthread_mutex_unlock(&mutex);
+    p_current_task->run(task_idx);
+    pthread_mutex_lock(&mutex);
+    if (--num_unfinished == 0) {
+        pthread_cond_signal(&work_done);
+    }
+}
@@ -42,10 +42,13 @@ View::View(const MatrixD &data,
     const map<int, vector<double> > &VM_A_GRIDS,
     const map<int, vector<double> > &VM_KAPPA_GRIDS,
     double CRP_ALPHA,
-    int SEED) : crp_alpha(CRP_ALPHA), rng(SEED)
+    int SEED) : crp_alpha(CRP_ALPHA), rng(SEED),
+    p_data_store(NULL)
 {
     crp_score = 0;
     data_score = 0;
+    sum_log_gamma_counts = 0;
+    num_vectors = 0;
     global_col_datatypes = GLOBAL_COL_DATATYPES;
     num_cols_effective = NUM_COLS_EFFECTIVE;
     //
@@ -78,10 +81,12 @@ View::View(const MatrixD &data,
     const map<int, vector<double> > &MU_GRIDS,
     const map<int, vector<double> > &VM_A_GRIDS,
     const map<int, vector<double> > &VM_KAPPA_GRIDS,
-    int SEED) : rng(SEED)
+    int SEED) : rng(SEED), p_data_store(NULL)
 {
     crp_score = 0;
     data_score = 0;
+    sum_log_gamma_counts = 0;
+    num_vectors = 0;
     global_col_datatypes = GLOBAL_COL_DATATYPES;
     //
     crp_alpha_grid = ROW_CRP_ALPHA_GRID;
@@ -114,10 +119,12 @@ View::View(const map<int, string> &GLOBAL_COL_DATATYPES,
     const map<int, vector<double> > &MU_GRIDS,
     const map<int, vector<double> > &VM_A_GRIDS,
     const map<int, vector<double> > &VM_KAPPA_GRIDS,
-    int SEED) : rng(SEED)
+    int SEED) : rng(SEED), p_data_store(NULL)
 {
     crp_score = 0;
     data_score = 0;
+    sum_log_gamma_counts = 0;
+    num_vectors = 0;
     global_col_datatypes = GLOBAL_COL_DATATYPES;
     num_cols_effective = 0;
     //
@@ -139,12 +146,12 @@ View::View(const map<int, string> &GLOBAL_COL_DATATYPES,
 
 double View::get_num_vectors() const
 {
-    return cluster_lookup.size();
+    return num_vectors;
 }
 
 double View::get_num_cols() const
 {
-    return global_to_local.size();
+    return local_to_global.size();
 }
 
 int View::get_num_cols_effective() const
@@ -192,60 +199,70 @@ vector<double> View::get_crp_alpha_grid() const
 vector<string> View::get_hyper_strings(int which_col)
 {
     vector<string> hyper_strings;
-    int global_col_idx = get_key_of_value(global_to_local, which_col);
-    // int global_col_idx = -1;
-    // map<int, int>::const_iterator it;
-    // for(it=global_to_local.begin(); it!=global_to_local.end(); ++it) {
-    //   if(it->second==which_col) {
-    //     global_col_idx = it->first;
-    //   }
-    // }
+    vector<HyperId> hyper_ids = get_hyper_ids(which_col);
+    vector<HyperId>::const_iterator it;
+    for (it = hyper_ids.begin(); it != hyper_ids.end(); ++it) {
+        hyper_strings.push_back(get_hyper_name(*it));
+    }
+    return hyper_strings;
+}
+
+vector<HyperId> View::get_hyper_ids(int which_col)
+{
+    vector<HyperId> hyper_ids;
+    int global_col_idx = local_to_global[which_col];
     string global_col_datatype = global_col_datatypes[global_col_idx];
     if (global_col_datatype == CONTINUOUS_DATATYPE) {
-        hyper_strings.push_back("r");
-        hyper_strings.push_back("nu");
-        hyper_strings.push_back("s");
-        hyper_strings.push_back("mu");
+        hyper_ids.push_back(HYPER_R);
+        hyper_ids.push_back(HYPER_NU);
+        hyper_ids.push_back(HYPER_S);
+        hyper_ids.push_back(HYPER_MU);
     } else if (global_col_datatype == CYCLIC_DATATYPE) {
-        hyper_strings.push_back("a");
-        hyper_strings.push_back("b");
-        hyper_strings.push_back("kappa");
+        hyper_ids.push_back(HYPER_A);
+        hyper_ids.push_back(HYPER_B);
+        hyper_ids.push_back(HYPER_KAPPA);
     } else if (global_col_datatype == MULTINOMIAL_DATATYPE) {
-        hyper_strings.push_back("dirichlet_alpha");
+        hyper_ids.push_back(HYPER_DIRICHLET_ALPHA);
     } else {
-        cout << "View::get_hyper_strings(" << which_col <<
+        cout << "View::get_hyper_ids(" << which_col <<
             "): invalid global_col_datatype: " << global_col_datatype << endl;
         assert(0);
     }
-    return hyper_strings;
+    return hyper_ids;
 }
 
 vector<double> View::get_hyper_grid(int global_col_idx,
     const string &which_hyper)
 {
-    vector<double> hyper_grid;
-    if (which_hyper == "r") {
-        hyper_grid = r_grid;
-    } else if (which_hyper == "nu") {
-        hyper_grid = nu_grid;
-    } else if (which_hyper == "s") {
-        hyper_grid = s_grids[global_col_idx];
-    } else if (which_hyper == "mu") {
-        hyper_grid = mu_grids[global_col_idx];
-    } else if (which_hyper == "dirichlet_alpha") {
-        hyper_grid = multinomial_alpha_grid;
-    } else if (which_hyper == "a") {
-        hyper_grid = vm_a_grids[global_col_idx];
-    } else if (which_hyper == "b") {
-        hyper_grid = vm_b_grid;
-    } else if (which_hyper == "kappa") {
-        hyper_grid = vm_kappa_grids[global_col_idx];
-    } else {
-        cout << "View::get_hyper_grid(" << global_col_idx << ", " << which_hyper <<
-            "): invalid which_hyper" << endl;
+    return get_hyper_grid(global_col_idx, get_hyper_id(which_hyper));
+}
+
+const vector<double> &View::get_hyper_grid(int global_col_idx,
+    HyperId which_hyper)
+{
+    switch (which_hyper) {
+    case HYPER_R:
+        return r_grid;
+    case HYPER_NU:
+        return nu_grid;
+    case HYPER_S:
+        return s_grids[global_col_idx];
+    case HYPER_MU:
+        return mu_grids[global_col_idx];
+    case HYPER_DIRICHLET_ALPHA:
+        return multinomial_alpha_grid;
+    case HYPER_A:
+        return vm_a_grids[global_col_idx];
+    case HYPER_B:
+        return vm_b_grid;
+    case HYPER_KAPPA:
+        return vm_kappa_grids[global_col_idx];
+    default:
+        cout << "View::get_hyper_grid(" << global_col_idx << ", " <<
+            get_hyper_name(which_hyper) << "): invalid which_hyper" << endl;
         assert(0);
+        exit(EXIT_FAILURE);
     }
-    return hyper_grid;
 }
 
 CM_Hypers View::get_hypers(int local_col_idx) const
@@ -269,9 +286,10 @@ vector<map<string, double> > View::get_column_component_suffstats_i(
     int global_col_idx) const
 {
     vector<map<string, double> > column_component_suffstats;
+    assert(global_to_local[global_col_idx] != -1);
+    int local_col_idx = global_to_local[global_col_idx];
     vector<Cluster *>::const_iterator it = clusters.begin();
     for (; it != clusters.end(); ++it) {
-        int local_col_idx = get(global_to_local, global_col_idx);
         map<string, double> suffstats = (**it).get_suffstats_i(local_col_idx);
         column_component_suffstats.push_back(suffstats);
     }
@@ -282,9 +300,12 @@ vector<vector<map<string, double> > > View::get_column_component_suffstats()
 const
 {
     vector<vector<map<string, double> > > column_component_suffstats;
-    map<int, int>::const_iterator it;
-    for (it = global_to_local.begin(); it != global_to_local.end(); ++it) {
-        int global_col_idx = it->first;
+    int num_global_cols = global_to_local.size();
+    for (int global_col_idx = 0; global_col_idx < num_global_cols;
+        global_col_idx++) {
+        if (global_to_local[global_col_idx] == -1) {
+            continue;
+        }
         vector<map<string, double> > column_component_suffstats_i = \
             get_column_component_suffstats_i(global_col_idx);
         column_component_suffstats.push_back(column_component_suffstats_i);
@@ -294,13 +315,7 @@ const
 
 vector<int> View::get_global_col_indices()
 {
-    int num_cols = get_num_cols();
-    vector<int> global_col_indices;
-    for (int local_col_idx = 0; local_col_idx < num_cols; local_col_idx++) {
-        int global_col_idx = get_key_of_value(global_to_local, local_col_idx);
-        global_col_indices.push_back(global_col_idx);
-    }
-    return global_col_indices;
+    return local_to_global;
 }
 
 Cluster &View::get_cluster(int cluster_idx)
@@ -317,7 +332,8 @@ Cluster &View::get_cluster(int cluster_idx)
 
 vector<double> View::get_draw(int row_idx, int random_seed) const
 {
-    Cluster &cluster = *get(cluster_lookup, row_idx);
+    assert(row_idx < (int) row_clusters.size() && row_clusters[row_idx]);
+    Cluster &cluster = *row_clusters[row_idx];
     vector<double> draw = cluster.get_draw(random_seed);
     return draw;
 }
@@ -355,42 +371,43 @@ double View::calc_cluster_vector_predictive_logp(const vector<double> &vd,
 vector<double> View::calc_cluster_vector_predictive_logps(
     const vector<double> &vd)
 {
-    vector<double> logps;
-    vector<Cluster *>::const_iterator it = clusters.begin();
-    double crp_logp_delta, data_logp_delta;
-    for (; it != clusters.end(); ++it) {
-        logps.push_back(calc_cluster_vector_predictive_logp(vd, **it, crp_logp_delta,
-                data_logp_delta));
+    // data terms for every cluster plus an empty one, in one columnar pass
+    suffstat_table.calc_row_predictive_logps(vd, data_logps_buffer);
+    int num_clusters = clusters.size();
+    int num_vectors = get_num_vectors();
+    vector<double> logps(num_clusters + 1);
+    for (int cluster_idx = 0; cluster_idx <= num_clusters; cluster_idx++) {
+        int cluster_count = cluster_idx == num_clusters ? 0 :
+            clusters[cluster_idx]->get_count();
+        double crp_logp_delta = numerics::calc_cluster_crp_logp(cluster_count,
+                num_vectors,
+                crp_alpha);
+        logps[cluster_idx] = crp_logp_delta + data_logps_buffer[cluster_idx];
     }
-    Cluster empty_cluster(hypers_v);
-    logps.push_back(calc_cluster_vector_predictive_logp(vd, empty_cluster,
-            crp_logp_delta,
-            data_logp_delta));
-    empty_cluster.delete_component_models();
     return logps;
 }
 
 double View::calc_crp_marginal() const
 {
     int num_vectors = get_num_vectors();
-    vector<int> cluster_counts = get_cluster_counts();
-    return numerics::calc_crp_alpha_conditional(cluster_counts, crp_alpha,
-            num_vectors, true);
+    return numerics::calc_crp_alpha_conditional(get_num_clusters(),
+            num_vectors, sum_log_gamma_counts, crp_alpha, lgamma_table);
 }
 
 vector<double> View::calc_crp_marginals(const vector<double> &alphas_to_score)
 const
 {
     int num_vectors = get_num_vectors();
-    vector<int> cluster_counts = get_cluster_counts();
+    int num_clusters = get_num_clusters();
     vector<double> crp_scores;
     vector<double>::const_iterator it = alphas_to_score.begin();
     for (; it != alphas_to_score.end(); ++it) {
         double alpha_to_score = *it;
-        double this_crp_score = numerics::calc_crp_alpha_conditional(cluster_counts,
-                alpha_to_score,
+        double this_crp_score = numerics::calc_crp_alpha_conditional(num_clusters,
                 num_vectors,
-                true);
+                sum_log_gamma_counts,
+                alpha_to_score,
+                lgamma_table);
         crp_scores.push_back(this_crp_score);
     }
     return crp_scores;
@@ -400,6 +417,23 @@ vector<double> View::calc_hyper_conditionals(int which_col,
     const string &which_hyper,
     const vector<double> &hyper_grid) const
 {
+    return calc_hyper_conditionals(which_col, get_hyper_id(which_hyper),
+            hyper_grid);
+}
+
+vector<double> View::calc_hyper_conditionals(int which_col,
+    HyperId which_hyper,
+    const vector<double> &hyper_grid) const
+{
+    if (which_hyper == HYPER_DIRICHLET_ALPHA) {
+        return suffstat_table.calc_dirichlet_alpha_conditionals(which_col,
+                hyper_grid, lgamma_table);
+    }
+    if (which_hyper == HYPER_R || which_hyper == HYPER_NU
+        || which_hyper == HYPER_S || which_hyper == HYPER_MU) {
+        return suffstat_table.calc_continuous_hyper_conditionals(which_col,
+                which_hyper, hyper_grid);
+    }
     vector<Cluster *>::const_iterator it;
     vector<vector<double> > vec_vec;
     for (it = clusters.begin(); it != clusters.end(); ++it) {
@@ -412,15 +446,21 @@ vector<double> View::calc_hyper_conditionals(int which_col,
 
 double View::set_hyper(int which_col, const string &which_hyper,
     double new_value)
+{
+    return set_hyper(which_col, get_hyper_id(which_hyper), new_value);
+}
+
+double View::set_hyper(int which_col, HyperId which_hyper, double new_value)
 {
     vector<Cluster *>::const_iterator it;
     double score_delta = 0;
-    // FIXME: this should use a mutator Cluster::set_hyper
-    //        which in turn uses ComponentModel::set_hyper
-    (*hypers_v[which_col])[which_hyper] = new_value;
+    // the one string-keyed write; the clusters take the value directly
+    (*hypers_v[which_col])[get_hyper_name(which_hyper)] = new_value;
     for (it = clusters.begin(); it != clusters.end(); ++it) {
-        score_delta += (**it).incorporate_hyper_update(which_col);
+        score_delta += (**it).incorporate_hyper_update(which_col, which_hyper,
+                new_value);
     }
+    suffstat_table.incorporate_hyper_update(which_col);
     // DOES THIS CAUSE UNBOUNDED SCORE GROWTH?
     data_score += score_delta;
     return score_delta;
@@ -428,13 +468,21 @@ double View::set_hyper(int which_col, const string &which_hyper,
 
 double View::transition_hyper_i(int which_col, const string &which_hyper,
     const vector<double> &hyper_grid)
+{
+    return transition_hyper_i(which_col, get_hyper_id(which_hyper),
+            hyper_grid);
+}
+
+double View::transition_hyper_i(int which_col, HyperId which_hyper,
+    const vector<double> &hyper_grid)
 {
     //
     // draw new hyper
     vector<double> unorm_logps = calc_hyper_conditionals(which_col, which_hyper,
             hyper_grid);
     double rand_u = draw_rand_u();
-    int draw = numerics::draw_sample_unnormalized(unorm_logps, rand_u);
+    int draw = numerics::draw_sample_unnormalized(unorm_logps, rand_u,
+        sample_buffer);
     double new_hyper_value = hyper_grid[draw];
     //
     // update all clusters
@@ -445,9 +493,15 @@ double View::transition_hyper_i(int which_col, const string &which_hyper,
 
 double View::transition_hyper_i(int which_col, const string &which_hyper)
 {
-    vector<int> global_ordering = extract_global_ordering(global_to_local);
+    return transition_hyper_i(which_col, get_hyper_id(which_hyper));
+}
+
+double View::transition_hyper_i(int which_col, HyperId which_hyper)
+{
+    const vector<int> &global_ordering = local_to_global;
     int global_col_idx = global_ordering[which_col];
-    vector<double> hyper_grid = get_hyper_grid(global_col_idx, which_hyper);
+    const vector<double> &hyper_grid = get_hyper_grid(global_col_idx,
+            which_hyper);
     assert(hyper_grid.size() != 0);
     double score_delta = transition_hyper_i(which_col, which_hyper, hyper_grid);
     return score_delta;
@@ -455,13 +509,12 @@ double View::transition_hyper_i(int which_col, const string &which_hyper)
 
 double View::transition_hypers_i(int which_col)
 {
-    vector<string> hyper_strings = get_hyper_strings(which_col);
-    random_shuffle(hyper_strings.begin(), hyper_strings.end(), rng);
+    vector<HyperId> hyper_ids = get_hyper_ids(which_col);
+    random_shuffle(hyper_ids.begin(), hyper_ids.end(), rng);
     double score_delta = 0;
-    vector<string>::iterator it;
-    for (it = hyper_strings.begin(); it != hyper_strings.end(); ++it) {
-        string which_hyper = *it;
-        score_delta += transition_hyper_i(which_col, which_hyper);
+    vector<HyperId>::iterator it;
+    for (it = hyper_ids.begin(); it != hyper_ids.end(); ++it) {
+        score_delta += transition_hyper_i(which_col, *it);
     }
     return score_delta;
 }
@@ -477,6 +530,17 @@ double View::transition_hypers()
 }
 
 double View::transition(const map<int, vector<double> > &row_data_map)
+{
+    return transition_helper(&row_data_map);
+}
+
+double View::transition()
+{
+    return transition_helper(NULL);
+}
+
+double View::transition_helper(
+    const map<int, vector<double> > *p_row_data_map)
 {
     vector<int> which_transitions = create_sequence(3);
     random_shuffle(which_transitions.begin(), which_transitions.end(), rng);
@@ -487,7 +551,11 @@ double View::transition(const map<int, vector<double> > &row_data_map)
         if (which_transition == 0) {
             score_delta += transition_hypers();
         } else if (which_transition == 1) {
-            score_delta += transition_zs(row_data_map);
+            if (p_row_data_map == NULL) {
+                score_delta += transition_zs();
+            } else {
+                score_delta += transition_zs(*p_row_data_map);
+            }
         } else if (which_transition == 2) {
             score_delta += transition_crp_alpha();
         } else {
@@ -512,16 +580,52 @@ double View::calc_column_predictive_logp(const vector<double> &column_data,
     const vector<int> &data_global_row_indices,
     const CM_Hypers &hypers) const
 {
+    vector<vector<int> > cluster_groupings = get_cluster_groupings();
     double score_delta = 0;
-    vector<Cluster *>::const_iterator it;
-    for (it = clusters.begin(); it != clusters.end(); ++it) {
-        score_delta += (**it).calc_column_predictive_logp(column_data, col_datatype,
-                data_global_row_indices,
+    for (size_t cluster_idx = 0; cluster_idx < clusters.size(); cluster_idx++) {
+        score_delta += clusters[cluster_idx]->calc_column_predictive_logp(
+                column_data, col_datatype, cluster_groupings[cluster_idx],
                 hypers);
     }
     return score_delta;
 }
 
+double View::calc_column_predictive_logp(int global_col_idx,
+    const string &col_datatype,
+    const CM_Hypers &hypers) const
+{
+    assert(p_data_store != NULL);
+    int num_stored_rows = p_data_store->get_num_rows();
+    Suffstats empty_suffstats(col_datatype, hypers);
+    Suffstats suffstats = empty_suffstats;
+    vector<vector<int> > cluster_groupings = get_cluster_groupings();
+    double score_delta = 0;
+    for (size_t cluster_idx = 0; cluster_idx < clusters.size(); cluster_idx++) {
+        suffstats = empty_suffstats;
+        const vector<int> &row_indices = cluster_groupings[cluster_idx];
+        vector<int>::const_iterator row_it;
+        for (row_it = row_indices.begin(); row_it != row_indices.end();
+            ++row_it) {
+            if (*row_it < num_stored_rows) {
+                suffstats.insert_element(
+                    p_data_store->get_value(*row_it, global_col_idx));
+            }
+        }
+        score_delta += suffstats.calc_marginal_logp();
+    }
+    return score_delta;
+}
+
+string View::get_rng_state() const
+{
+    return rng.get_state();
+}
+
+void View::set_rng_state(const string &rng_state)
+{
+    rng.set_state(rng_state);
+}
+
 double View::set_crp_alpha(double new_crp_alpha)
 {
     double crp_score_0 = crp_score;
@@ -530,10 +634,23 @@ double View::set_crp_alpha(double new_crp_alpha)
     return crp_score - crp_score_0;
 }
 
+void View::set_data_store(const DataStore &data_store)
+{
+    p_data_store = &data_store;
+}
+
 Cluster &View::get_new_cluster()
 {
-    Cluster *p_new_cluster = new Cluster(hypers_v);
+    Cluster *p_new_cluster;
+    if (free_clusters.empty()) {
+        p_new_cluster = new Cluster(hypers_v);
+    } else {
+        p_new_cluster = free_clusters.back();
+        free_clusters.pop_back();
+        p_new_cluster->reset();
+    }
     clusters.push_back(p_new_cluster);
+    suffstat_table.insert_cluster();
     return *p_new_cluster;
 }
 
@@ -545,8 +662,24 @@ double View::insert_row(const vector<double> &vd, Cluster &which_cluster,
     double score_delta = calc_cluster_vector_predictive_logp(vd, which_cluster,
             crp_logp_delta,
             data_logp_delta);
+    int count = which_cluster.get_count();
     which_cluster.insert_row(vd, row_idx);
-    cluster_lookup[row_idx] = &which_cluster;
+    // lgamma(count + 1) - lgamma(count); a new cluster adds lgamma(1) = 0
+    if (count > 0) {
+        sum_log_gamma_counts += log(count);
+    }
+    suffstat_table.insert_row(get_cluster_idx(which_cluster), vd);
+    if (row_idx >= (int) row_clusters.size()) {
+        row_clusters.resize(row_idx + 1, NULL);
+    }
+    if (row_clusters[row_idx] != NULL) {
+        cout << "View::insert_row: row " << row_idx << " already present"
+            << endl;
+        assert(row_clusters[row_idx] == NULL);
+        exit(EXIT_FAILURE);
+    }
+    row_clusters[row_idx] = &which_cluster;
+    num_vectors++;
     crp_score += crp_logp_delta;
     data_score += data_logp_delta;
     return score_delta;
@@ -556,7 +689,7 @@ double View::insert_row(const vector<double> &vd,
     int matching_row_idx,
     int row_idx)
 {
-    Cluster &which_cluster = *cluster_lookup[matching_row_idx];
+    Cluster &which_cluster = *row_clusters[matching_row_idx];
     double score_delta = insert_row(vd, which_cluster, row_idx);
     return score_delta;
 }
@@ -565,7 +698,8 @@ double View::insert_row(const vector<double> &vd, int row_idx)
 {
     vector<double> unorm_logps = calc_cluster_vector_predictive_logps(vd);
     double rand_u = draw_rand_u();
-    int draw = numerics::draw_sample_unnormalized(unorm_logps, rand_u);
+    int draw = numerics::draw_sample_unnormalized(unorm_logps, rand_u,
+        sample_buffer);
     Cluster &which_cluster = get_cluster(draw);
     double score_delta = insert_row(vd, which_cluster, row_idx);
     return score_delta;
@@ -573,9 +707,19 @@ double View::insert_row(const vector<double> &vd, int row_idx)
 
 double View::remove_row(const vector<double> &vd, int row_idx)
 {
-    Cluster &which_cluster = *(cluster_lookup[row_idx]);
-    cluster_lookup.erase(cluster_lookup.find(row_idx));
+    if (row_idx >= (int) row_clusters.size() || !row_clusters[row_idx]) {
+        cout << "View::remove_row: row " << row_idx << " not present" << endl;
+        assert(false);
+        exit(EXIT_FAILURE);
+    }
+    Cluster &which_cluster = *row_clusters[row_idx];
+    row_clusters[row_idx] = NULL;
+    num_vectors--;
     which_cluster.remove_row(vd, row_idx);
+    if (which_cluster.get_count() > 0) {
+        sum_log_gamma_counts -= log(which_cluster.get_count());
+    }
+    suffstat_table.remove_row(get_cluster_idx(which_cluster), vd);
     double crp_logp_delta, data_logp_delta;
     double score_delta = calc_cluster_vector_predictive_logp(vd, which_cluster,
             crp_logp_delta,
@@ -616,15 +760,71 @@ double View::insert_col(const vector<double> &col_data,
 {
     double score_delta = 0;
     string col_datatype = global_col_datatypes[global_col_idx];
-    //
     hypers_v.push_back(&hypers);
-    vector<Cluster *>::const_iterator it;
-    for (it = clusters.begin(); it != clusters.end(); ++it) {
-        score_delta += (**it).insert_col(col_data, col_datatype,
-                data_global_row_indices, hypers);
+    suffstat_table.insert_col(col_datatype, hypers);
+    int table_col_idx = suffstat_table.get_num_cols() - 1;
+    vector<vector<int> > cluster_groupings = get_cluster_groupings();
+    int num_clusters = clusters.size();
+    for (int cluster_idx = 0; cluster_idx < num_clusters; cluster_idx++) {
+        Cluster &c = *clusters[cluster_idx];
+        const vector<int> &row_indices = cluster_groupings[cluster_idx];
+        score_delta += c.insert_col(col_data, col_datatype, row_indices,
+                hypers);
+        vector<int>::const_iterator row_it;
+        for (row_it = row_indices.begin(); row_it != row_indices.end();
+            ++row_it) {
+            suffstat_table.insert_element(cluster_idx, table_col_idx,
+                col_data[*row_it]);
+        }
+    }
+    // free clusters are empty
+    vector<int> no_rows;
+    vector<Cluster *>::iterator free_it;
+    for (free_it = free_clusters.begin(); free_it != free_clusters.end();
+        ++free_it) {
+        (**free_it).insert_col(col_data, col_datatype, no_rows, hypers);
+    }
+    int num_cols = get_num_cols();
+    if (global_col_idx >= (int) global_to_local.size()) {
+        global_to_local.resize(global_col_idx + 1, -1);
+    }
+    global_to_local[global_col_idx] = num_cols;
+    local_to_global.push_back(global_col_idx);
+    data_score += score_delta;
+    return score_delta;
+}
+
+double View::insert_col_suffstats(
+    const vector<const double *> &cluster_suffstats,
+    int global_col_idx, CM_Hypers &hypers)
+{
+    assert(cluster_suffstats.size() == clusters.size());
+    double score_delta = 0;
+    string col_datatype = global_col_datatypes[global_col_idx];
+    hypers_v.push_back(&hypers);
+    suffstat_table.insert_col(col_datatype, hypers);
+    int table_col_idx = suffstat_table.get_num_cols() - 1;
+    int num_clusters = clusters.size();
+    for (int cluster_idx = 0; cluster_idx < num_clusters; cluster_idx++) {
+        const double *suffstats = cluster_suffstats[cluster_idx];
+        score_delta += clusters[cluster_idx]->insert_col_suffstats(suffstats,
+                col_datatype, hypers);
+        suffstat_table.set_suffstats(cluster_idx, table_col_idx, suffstats);
+    }
+    // free clusters are empty
+    vector<double> no_data;
+    vector<int> no_rows;
+    vector<Cluster *>::iterator free_it;
+    for (free_it = free_clusters.begin(); free_it != free_clusters.end();
+        ++free_it) {
+        (**free_it).insert_col(no_data, col_datatype, no_rows, hypers);
     }
     int num_cols = get_num_cols();
+    if (global_col_idx >= (int) global_to_local.size()) {
+        global_to_local.resize(global_col_idx + 1, -1);
+    }
     global_to_local[global_col_idx] = num_cols;
+    local_to_global.push_back(global_col_idx);
     data_score += score_delta;
     return score_delta;
 }
@@ -656,11 +856,20 @@ double View::remove_col(int global_col_idx)
     for (it = clusters.begin(); it != clusters.end(); ++it) {
         score_delta += (*it)->remove_col(local_col_idx);
     }
-    // rearrange global_to_local
-    vector<int> global_col_indices = extract_global_ordering(global_to_local);
-    global_col_indices.erase(global_col_indices.begin() + local_col_idx);
-    hypers_v.erase(hypers_v.begin() + local_col_idx);
-    global_to_local = construct_lookup_map(global_col_indices);
+    for (it = free_clusters.begin(); it != free_clusters.end(); ++it) {
+        (*it)->remove_col(local_col_idx);
+    }
+    suffstat_table.remove_col(local_col_idx);
+    // the last local column takes the freed slot, as in Cluster::remove_col
+    // and SuffstatTable::remove_col
+    int last_col_idx = local_to_global.size() - 1;
+    int last_global_col_idx = local_to_global[last_col_idx];
+    hypers_v[local_col_idx] = hypers_v[last_col_idx];
+    hypers_v.pop_back();
+    local_to_global[local_col_idx] = last_global_col_idx;
+    local_to_global.pop_back();
+    global_to_local[last_global_col_idx] = local_col_idx;
+    global_to_local[global_col_idx] = -1;
     //
     data_score -= score_delta;
     return score_delta;
@@ -672,9 +881,9 @@ void View::remove_if_empty(Cluster &which_cluster)
         vector<Cluster *>::iterator it;
         for (it = clusters.begin(); it != clusters.end(); ++it) {
             if (*it == &which_cluster) {
+                suffstat_table.remove_cluster(it - clusters.begin());
                 clusters.erase(it);
-                which_cluster.delete_component_models();
-                delete &which_cluster;
+                free_clusters.push_back(&which_cluster);
                 break;
             }
         }
@@ -683,7 +892,9 @@ void View::remove_if_empty(Cluster &which_cluster)
 
 void View::remove_all()
 {
-    cluster_lookup.clear();
+    row_clusters.clear();
+    sum_log_gamma_counts = 0;
+    num_vectors = 0;
     vector<Cluster *>::const_iterator it = clusters.begin();
     for (; it != clusters.end(); ++it) {
         Cluster &which_cluster = **it;
@@ -691,6 +902,15 @@ void View::remove_all()
         delete &which_cluster;
     }
     clusters.resize(0);
+    for (it = free_clusters.begin(); it != free_clusters.end(); ++it) {
+        Cluster &which_cluster = **it;
+        which_cluster.delete_component_models();
+        delete &which_cluster;
+    }
+    free_clusters.resize(0);
+    while (suffstat_table.get_num_clusters() != 0) {
+        suffstat_table.remove_cluster(suffstat_table.get_num_clusters() - 1);
+    }
 }
 
 double View::transition_z(const vector<double> &vd, int row_idx)
@@ -704,8 +924,8 @@ double View::transition_z(const vector<double> &vd, int row_idx)
 double View::transition_zs(const map<int, vector<double> > &row_data_map)
 {
     double score_delta = 0;
-    vector<int> shuffled_row_indices = shuffle_row_indices();
-    vector<int>::iterator it = shuffled_row_indices.begin();
+    const vector<int> &shuffled_row_indices = shuffle_row_indices();
+    vector<int>::const_iterator it = shuffled_row_indices.begin();
     for (; it != shuffled_row_indices.end(); ++it) {
         int row_idx = *it;
         const vector<double> &vd = get(row_data_map, row_idx);
@@ -714,6 +934,166 @@ double View::transition_zs(const map<int, vector<double> > &row_data_map)
     return score_delta;
 }
 
+double View::transition_zs()
+{
+    return transition_zs(shuffle_row_indices());
+}
+
+double View::transition_zs(const vector<int> &row_indices)
+{
+    assert(p_data_store != NULL);
+    const vector<int> &global_ordering = local_to_global;
+    double score_delta = 0;
+    vector<int>::const_iterator it = row_indices.begin();
+    for (; it != row_indices.end(); ++it) {
+        int row_idx = *it;
+        read_row(row_idx, global_ordering, row_buffer);
+        score_delta += transition_z(row_buffer, row_idx);
+    }
+    return score_delta;
+}
+
+double View::transition_zs_subsample(int num_rows)
+{
+    int num_total = num_vectors;
+    if (num_rows >= num_total) {
+        return transition_zs();
+    }
+    fill_row_order();
+    // partial Fisher-Yates: the first num_rows slots are the subset
+    for (int i = 0; i < num_rows; i++) {
+        int j = i + draw_rand_i(num_total - i);
+        std::swap(row_order[i], row_order[j]);
+    }
+    row_order.resize(std::max(num_rows, 0));
+    return transition_zs(row_order);
+}
+
+double View::transition_split_merge()
+{
+    assert(p_data_store != NULL);
+    int num_rows = num_vectors;
+    if (num_rows < 2) {
+        return 0;
+    }
+    // two distinct anchor rows
+    fill_row_order();
+    int i_draw = draw_rand_i(num_rows);
+    int j_draw = draw_rand_i(num_rows - 1);
+    if (j_draw >= i_draw) {
+        j_draw++;
+    }
+    int row_i = row_order[i_draw];
+    int row_j = row_order[j_draw];
+    Cluster &cluster_i = *row_clusters[row_i];
+    Cluster &cluster_j = *row_clusters[row_j];
+    bool is_split = &cluster_i == &cluster_j;
+    //
+    // the other rows of the anchors' clusters, in random order, with
+    // whether each is in cluster_j
+    vector<int> others;
+    vector<bool> others_in_j;
+    vector<int> members = get_row_indices(cluster_i);
+    for (size_t idx = 0; idx < members.size(); idx++) {
+        if (members[idx] != row_i && members[idx] != row_j) {
+            others.push_back(members[idx]);
+            others_in_j.push_back(false);
+        }
+    }
+    if (!is_split) {
+        members = get_row_indices(cluster_j);
+        for (size_t idx = 0; idx < members.size(); idx++) {
+            if (members[idx] != row_j) {
+                others.push_back(members[idx]);
+                others_in_j.push_back(true);
+            }
+        }
+    }
+    int num_others = others.size();
+    for (int idx = num_others - 1; idx > 0; idx--) {
+        int swap_idx = draw_rand_i(idx + 1);
+        std::swap(others[idx], others[swap_idx]);
+        bool in_j = others_in_j[idx];
+        others_in_j[idx] = others_in_j[swap_idx];
+        others_in_j[swap_idx] = in_j;
+    }
+    const vector<int> &global_ordering = local_to_global;
+    vector<vector<double> > others_data(num_others);
+    for (int idx = 0; idx < num_others; idx++) {
+        read_row(others[idx], global_ordering, others_data[idx]);
+    }
+    vector<double> data_j;
+    read_row(row_j, global_ordering, data_j);
+    //
+    double score_0 = get_score();
+    // Take the others out, leaving each anchor alone in its cluster, and
+    // seat them again one at a time.  For a split the seats are drawn;
+    // for a merge they are the current ones, and log_q is what the split
+    // that would undo the merge has to pay to propose them.
+    for (int idx = 0; idx < num_others; idx++) {
+        remove_row(others_data[idx], others[idx]);
+    }
+    Cluster *p_cluster_j = &cluster_j;
+    if (is_split) {
+        remove_row(data_j, row_j);
+        p_cluster_j = &get_new_cluster();
+        insert_row(data_j, *p_cluster_j, row_j);
+    }
+    double log_q = 0;
+    for (int idx = 0; idx < num_others; idx++) {
+        const vector<double> &vd = others_data[idx];
+        double logp_i, logp_j;
+        calc_two_cluster_logps(vd, cluster_i, *p_cluster_j, logp_i, logp_j);
+        if (is_split) {
+            others_in_j[idx] = !(log(draw_rand_u()) < logp_i);
+        }
+        if (others_in_j[idx]) {
+            log_q += logp_j;
+            insert_row(vd, *p_cluster_j, others[idx]);
+        } else {
+            log_q += logp_i;
+            insert_row(vd, cluster_i, others[idx]);
+        }
+    }
+    //
+    // the rows that the merge moves, or that the split moved
+    vector<int> moved_rows(1, row_j);
+    vector<const vector<double> *> moved_data(1, &data_j);
+    for (int idx = 0; idx < num_others; idx++) {
+        if (others_in_j[idx]) {
+            moved_rows.push_back(others[idx]);
+            moved_data.push_back(&others_data[idx]);
+        }
+    }
+    int num_moved = moved_rows.size();
+    if (!is_split) {
+        for (int idx = 0; idx < num_moved; idx++) {
+            remove_row(*moved_data[idx], moved_rows[idx]);
+            insert_row(*moved_data[idx], cluster_i, moved_rows[idx]);
+        }
+    }
+    double log_accept = get_score() - score_0 + (is_split ? -log_q : log_q);
+    if (log(draw_rand_u()) < log_accept) {
+        return get_score() - score_0;
+    }
+    // rejected: move them back
+    Cluster &restored_cluster = is_split ? cluster_i : get_new_cluster();
+    for (int idx = 0; idx < num_moved; idx++) {
+        remove_row(*moved_data[idx], moved_rows[idx]);
+        insert_row(*moved_data[idx], restored_cluster, moved_rows[idx]);
+    }
+    return get_score() - score_0;
+}
+
+double View::transition_split_merges(int num_proposals)
+{
+    double score_delta = 0;
+    for (int proposal_idx = 0; proposal_idx < num_proposals; proposal_idx++) {
+        score_delta += transition_split_merge();
+    }
+    return score_delta;
+}
+
 double View::transition_crp_alpha()
 {
     // to make score_crp not calculate absolute, need to track score deltas
@@ -721,7 +1101,8 @@ double View::transition_crp_alpha()
     double crp_score_0 = get_crp_score();
     vector<double> unorm_logps = calc_crp_marginals(crp_alpha_grid);
     double rand_u = draw_rand_u();
-    int draw = numerics::draw_sample_unnormalized(unorm_logps, rand_u);
+    int draw = numerics::draw_sample_unnormalized(unorm_logps, rand_u,
+        sample_buffer);
     crp_alpha = crp_alpha_grid[draw];
     crp_score = unorm_logps[draw];
     double crp_score_delta = crp_score - crp_score_0;
@@ -731,35 +1112,75 @@ double View::transition_crp_alpha()
 vector<double> View::align_data(const vector<double> &raw_values,
     const vector<int> &global_column_indices) const
 {
-    return reorder_per_map(raw_values, global_column_indices, global_to_local);
+    // data index of each global column index
+    vector<int> global_to_data(global_to_local.size(), -1);
+    int num_data_cols = global_column_indices.size();
+    for (int data_col_idx = 0; data_col_idx < num_data_cols; data_col_idx++) {
+        int global_col_idx = global_column_indices[data_col_idx];
+        if (global_col_idx < (int) global_to_data.size()) {
+            global_to_data[global_col_idx] = data_col_idx;
+        }
+    }
+    int num_cols = local_to_global.size();
+    vector<double> aligned_values(num_cols);
+    for (int local_col_idx = 0; local_col_idx < num_cols; local_col_idx++) {
+        int data_col_idx = global_to_data[local_to_global[local_col_idx]];
+        assert(data_col_idx != -1);
+        aligned_values[local_col_idx] = raw_values[data_col_idx];
+    }
+    return aligned_values;
 }
 
-vector<int> View::shuffle_row_indices()
+void View::fill_row_order()
+{
+    row_order.resize(num_vectors);
+    vector<int>::iterator order_it = row_order.begin();
+    int num_slots = row_clusters.size();
+    for (int row_idx = 0; row_idx < num_slots; row_idx++) {
+        if (row_clusters[row_idx] != NULL) {
+            *order_it++ = row_idx;
+        }
+    }
+}
+
+const vector<int> &View::shuffle_row_indices()
 {
     // can't use std::random_shuffle b/c need to control seed
-    vector<int> original_order;
-    map<int, Cluster *>::iterator it = cluster_lookup.begin();
-    for (; it != cluster_lookup.end(); ++it) {
-        original_order.push_back(it->first);
+    fill_row_order();
+    for (int i = (int) row_order.size() - 1; i > 0; i--) {
+        int j = draw_rand_i(i + 1);
+        std::swap(row_order[i], row_order[j]);
     }
-    vector<int> shuffled_order;
-    while (original_order.size() != 0) {
-        int draw = draw_rand_i(original_order.size());
-        int row_idx = original_order[draw];
-        shuffled_order.push_back(row_idx);
-        original_order.erase(original_order.begin() + draw);
+    return row_order;
+}
+
+vector<int> View::get_row_indices(const Cluster &which_cluster) const
+{
+    vector<int> row_indices;
+    row_indices.reserve(which_cluster.get_count());
+    int num_slots = row_clusters.size();
+    for (int row_idx = 0; row_idx < num_slots; row_idx++) {
+        if (row_clusters[row_idx] == &which_cluster) {
+            row_indices.push_back(row_idx);
+        }
     }
-    return shuffled_order;
+    return row_indices;
 }
 
 vector<vector<int> > View::get_cluster_groupings() const
 {
-    vector<vector<int> > cluster_groupings;
-    vector<Cluster *>::const_iterator it;
-    for (it = clusters.begin(); it != clusters.end(); ++it) {
-        Cluster &c = **it;
-        vector<int> row_indices = c.get_row_indices_vector();
-        cluster_groupings.push_back(row_indices);
+    map<Cluster *, int> view_to_int = vector_to_map(clusters);
+    vector<vector<int> > cluster_groupings(clusters.size());
+    for (size_t cluster_idx = 0; cluster_idx < clusters.size(); cluster_idx++) {
+        cluster_groupings[cluster_idx].reserve(
+            clusters[cluster_idx]->get_count());
+    }
+    int num_slots = row_clusters.size();
+    for (int row_idx = 0; row_idx < num_slots; row_idx++) {
+        Cluster *p_c = row_clusters[row_idx];
+        if (p_c != NULL) {
+            cluster_groupings[view_to_int[p_c]].push_back(row_idx);
+        }
     }
     return cluster_groupings;
 }
@@ -768,9 +1189,9 @@ vector<int> View::get_canonical_clustering() const
 {
     map<Cluster *, int> view_to_int = vector_to_map(clusters);
     vector<int> canonical_clustering;
-    for (unsigned int i = 0; i < cluster_lookup.size(); i++) {
-        Cluster *p_c = cluster_lookup.find(i)->second;
-        int canonical_cluster_idx = view_to_int[p_c];
+    canonical_clustering.reserve(num_vectors);
+    for (int i = 0; i < num_vectors; i++) {
+        int canonical_cluster_idx = view_to_int[row_clusters[i]];
         canonical_clustering.push_back(canonical_cluster_idx);
     }
     return canonical_clustering;
@@ -793,7 +1214,7 @@ string View::to_string(const string &join_str, bool top_level) const
             ss << **it << endl;
         }
     }
-    ss << "global_to_local: " << global_to_local << join_str;
+    ss << "local_to_global: " << local_to_global << join_str;
     ss << "crp_score: " << get_crp_score();
     ss << ", " << "data_score: " << get_data_score();
     ss << ", " << "score: " << get_score();
@@ -827,6 +1248,43 @@ void View::print()
 //  assert(is_almost(get_crp_score(),calc_crp_marginal(), tolerance));
 //}
 
+int View::get_cluster_idx(const Cluster &which_cluster) const
+{
+    int num_clusters = clusters.size();
+    for (int cluster_idx = 0; cluster_idx < num_clusters; cluster_idx++) {
+        if (clusters[cluster_idx] == &which_cluster) {
+            return cluster_idx;
+        }
+    }
+    assert(false);
+    return -1;
+}
+
+void View::read_row(int row_idx, const vector<int> &global_ordering,
+    vector<double> &vd) const
+{
+    if (row_idx < p_data_store->get_num_rows()) {
+        p_data_store->get_row(row_idx, global_ordering, vd);
+    } else {
+        vd.clear();
+    }
+}
+
+void View::calc_two_cluster_logps(const vector<double> &vd,
+    const Cluster &a, const Cluster &b, double &logp_a, double &logp_b) const
+{
+    double crp_logp_delta, data_logp_delta;
+    double score_a = calc_cluster_vector_predictive_logp(vd, a,
+            crp_logp_delta, data_logp_delta);
+    double score_b = calc_cluster_vector_predictive_logp(vd, b,
+            crp_logp_delta, data_logp_delta);
+    // normalize by log(exp(score_a) + exp(score_b)), without overflow
+    double log_partition = std::max(score_a, score_b)
+        + log1p(exp(-fabs(score_a - score_b)));
+    logp_a = score_a - log_partition;
+    logp_b = score_b - log_partition;
+}
+
 double View::draw_rand_u()
 {
     return rng.next();
@@ -17,7 +17,13 @@
 *   See the License for the specific language governing permissions and
 *   limitations under the License.
 */
+#include <cstring>
+#include <stdint.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 #include "numerics.h"
+#include "LgammaTable.h"
 
 using namespace std;
 
@@ -228,6 +234,12 @@ double log_bessel_0(double x)
     return log(i0);
 }
 
+double log_gamma(double x)
+{
+    int sign;
+    return lgamma_r(x, &sign);
+}
+
 double calc_crp_alpha_hyperprior(double alpha)
 {
     double logp = 0;
@@ -247,13 +259,8 @@ double calc_continuous_hyperprior(double r, double nu, double s)
 
 double logaddexp(const vector<double> &logs)
 {
-    double maximum = *std::max_element(logs.begin(), logs.end());
-    double result = 0;
-    vector<double>::const_iterator it;
-    for (it = logs.begin(); it != logs.end(); it++) {
-        result += exp(*it - maximum);
-    }
-    return log(result) + maximum;
+    assert(!logs.empty());
+    return logsumexp(&logs[0], logs.size());
 }
 
 // draw_sample_unnormalized(unorm_logps, rand_u)
@@ -304,6 +311,94 @@ int draw_sample_unnormalized(const vector<double> &unorm_logps,
     return draw_sample_with_partition(shifted_logps, log(partition), rand_u);
 }
 
+// draw_sample_unnormalized(unorm_logps, rand_u, scratch)
+//
+//  As above, without allocating and with one exp per entry rather
+//  than two, for the hot paths: scratch, which callers keep across
+//  draws, holds the running sums C_i = \sum_{k=0}^i q_k.  The draw
+//  is the first i with u*C_{n-1} < C_i, found by binary search;
+//  entries with q_i = 0 repeat the previous sum and so are never
+//  chosen.  Rounding can leave u*C_{n-1} >= C_{n-1} only for u = 1,
+//  and then the last entry is drawn.
+//
+int draw_sample_unnormalized(const vector<double> &unorm_logps,
+    double rand_u, vector<double> &scratch)
+{
+    const size_t N = unorm_logps.size();
+    assert(0 < N);
+    scratch.resize(N);
+    double max_el = *std::max_element(unorm_logps.begin(), unorm_logps.end());
+    double cumulative = 0;
+    for (size_t i = 0; i < N; i++) {
+        cumulative += exp(unorm_logps[i] - max_el);
+        scratch[i] = cumulative;
+    }
+    double target = rand_u * cumulative;
+    size_t draw = std::upper_bound(scratch.begin(), scratch.end(), target)
+        - scratch.begin();
+    return std::min(draw, N - 1);
+}
+
+// build_alias_table(unorm_logps, alias_probs, aliases)
+//
+//  Walker's alias method, with Vose's stable construction, for many
+//  draws from one distribution: after O(n) setup each draw costs one
+//  uniform and one comparison.  Column i of the table keeps i with
+//  probability alias_probs[i] and otherwise yields aliases[i].
+//
+void build_alias_table(const vector<double> &unorm_logps,
+    vector<double> &alias_probs, vector<int> &aliases)
+{
+    const int N = unorm_logps.size();
+    assert(0 < N);
+    alias_probs.resize(N);
+    aliases.resize(N);
+    double max_el = *std::max_element(unorm_logps.begin(), unorm_logps.end());
+    double partition = 0;
+    for (int i = 0; i < N; i++) {
+        alias_probs[i] = exp(unorm_logps[i] - max_el);
+        partition += alias_probs[i];
+    }
+    // scale so the average column holds exactly 1
+    vector<int> small, large;
+    for (int i = 0; i < N; i++) {
+        alias_probs[i] *= N / partition;
+        aliases[i] = i;
+        if (alias_probs[i] < 1) {
+            small.push_back(i);
+        } else {
+            large.push_back(i);
+        }
+    }
+    while (!small.empty() && !large.empty()) {
+        int less = small.back();
+        int more = large.back();
+        small.pop_back();
+        aliases[less] = more;
+        alias_probs[more] -= 1 - alias_probs[less];
+        if (alias_probs[more] < 1) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // what is left over is 1 up to rounding
+    for (size_t i = 0; i < small.size(); i++) {
+        alias_probs[small[i]] = 1;
+    }
+    for (size_t i = 0; i < large.size(); i++) {
+        alias_probs[large[i]] = 1;
+    }
+}
+
+int draw_sample_alias(const vector<double> &alias_probs,
+    const vector<int> &aliases, double rand_u)
+{
+    const int N = alias_probs.size();
+    double scaled = rand_u * N;
+    int column = std::min(static_cast<int>(scaled), N - 1);
+    return scaled - column < alias_probs[column] ? column : aliases[column];
+}
+
 // draw_sample_with_partition(unorm_logps, log_partition, rand_u)
 //
 //  unorm_logps is an array [u_0, u_1, ..., u_{n-1}], where each
@@ -384,15 +479,39 @@ double calc_crp_alpha_conditional(const vector<int> &counts,
     if (sum_counts == -1) {
         sum_counts = std::accumulate(counts.begin(), counts.end(), 0);
     }
-    double logp = lgamma(alpha)         \
+    double logp = log_gamma(alpha)         \
         + num_clusters * log(alpha)           \
-        - lgamma(alpha + sum_counts);
+        - log_gamma(alpha + sum_counts);
     // absolute necessary for determining true distribution rather than relative
     if (absolute) {
         double sum_log_gammas = 0;
         vector<int>::const_iterator it = counts.begin();
         for (; it != counts.end(); it++) {
-            sum_log_gammas += lgamma(*it);
+            sum_log_gammas += log_gamma(*it);
+        }
+        logp += sum_log_gammas;
+    }
+    logp += calc_crp_alpha_hyperprior(alpha);
+    return logp;
+}
+
+double calc_crp_alpha_conditional(const vector<int> &counts,
+    double alpha, int sum_counts,
+    bool absolute, LgammaTable &lgamma_table)
+{
+    int num_clusters = counts.size();
+    if (sum_counts == -1) {
+        sum_counts = std::accumulate(counts.begin(), counts.end(), 0);
+    }
+    // sum_counts is the row count, too large to tabulate per alpha
+    double logp = lgamma_table.lgamma_shifted(0, alpha)         \
+        + num_clusters * log(alpha)           \
+        - log_gamma(sum_counts + alpha);
+    if (absolute) {
+        double sum_log_gammas = 0;
+        vector<int>::const_iterator it = counts.begin();
+        for (; it != counts.end(); it++) {
+            sum_log_gammas += lgamma_table.lgamma_shifted(*it, 0);
         }
         logp += sum_log_gammas;
     }
@@ -400,6 +519,19 @@ double calc_crp_alpha_conditional(const vector<int> &counts,
     return logp;
 }
 
+double calc_crp_alpha_conditional(int num_clusters, int sum_counts,
+    double sum_log_gammas, double alpha, LgammaTable &lgamma_table)
+{
+    // only lgamma(alpha) is tabulated; a table per alpha up to the row
+    // count would cost O(sum_counts) memory
+    double logp = lgamma_table.lgamma_shifted(0, alpha)         \
+        + num_clusters * log(alpha)           \
+        - log_gamma(sum_counts + alpha);
+    logp += sum_log_gammas;
+    logp += calc_crp_alpha_hyperprior(alpha);
+    return logp;
+}
+
 // helper for may calls to calc_crp_alpha_conditional
 vector<double> calc_crp_alpha_conditionals(const vector<double> &grid,
     const vector<int> &counts,
@@ -499,7 +631,7 @@ double calc_continuous_log_Z(double r, double nu, double s)
     double log_Z = nu_over_2 * (LOG_2 - log(s))     \
         + HALF_LOG_2PI                    \
         - .5 * log(r)                 \
-        + lgamma(nu_over_2);
+        + log_gamma(nu_over_2);
     log_Z += calc_continuous_hyperprior(r, nu, s);
     return log_Z;
 }
@@ -530,6 +662,362 @@ double calc_continuous_data_logp(int count,
     return logp;
 }
 
+void calc_continuous_predictive_terms(int count,
+    double sum_x, double sum_x_sq,
+    double r, double nu, double s, double mu,
+    double log_Z_0, double score,
+    double &mu_n, double &s_n, double &weight, double &half_nu, double &base)
+{
+    // Adding el to a cluster with posterior (r_n, nu_n, s_n, mu_n) gives
+    //   r' = r_n + 1, nu' = nu_n + 1,
+    //   s' = s_n + r_n / (r_n + 1) * (el - mu_n)^2,
+    // so calc_continuous_logp(count + 1, r', nu', s', log_Z_0) - score
+    // splits into base - nu' / 2 * log(s') with base independent of el.
+    update_continuous_hypers(count, sum_x, sum_x_sq, r, nu, s, mu);
+    double r_prime = r + 1;
+    double nu_prime = nu + 1;
+    mu_n = mu;
+    s_n = s;
+    weight = r / r_prime;
+    half_nu = .5 * nu_prime;
+    base = -(count + 1) * HALF_LOG_2PI
+        + half_nu * LOG_2 + HALF_LOG_2PI
+        - .5 * log(r_prime)
+        + log_gamma(half_nu)
+        - log_Z_0 - score;
+}
+
+// Natural log of a positive, finite, normal x, after the Cephes
+// library's log (Stephen L. Moshier), without its special cases.  The
+// scalar and AVX2 versions below perform the same operations in the same
+// order, and the Makefile and setup.py pass -ffp-contract=off so neither
+// is compiled to fused multiply-adds.  They agree to the bit.
+static const double LOG_P[] = {
+    7.70838733755885391666E0,
+    1.79368678507819816313E1,
+    1.44989225341610930846E1,
+    4.70579119878881725854E0,
+    4.97494994976747001425E-1,
+    1.01875663804580931796E-4,
+};
+static const double LOG_Q[] = {
+    2.31251620126765340583E1,
+    7.11544750618563894466E1,
+    8.29875266912776603211E1,
+    4.52279145837532221105E1,
+    1.12873587189167450590E1,
+    1.00000000000000000000E0,
+};
+static const double LOG_SQRTH = 0.70710678118654752440;
+static const double LOG_C1 = 0.693359375;
+static const double LOG_C2 = -2.121944400546905827679E-4;
+
+static inline double batch_log(double x)
+{
+    // x = m * 2^e with m in [.5, 1)
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    double e = (double)(int)(bits >> 52) - 1022;
+    bits = (bits & 0x000fffffffffffffULL) | 0x3fe0000000000000ULL;
+    double m;
+    memcpy(&m, &bits, sizeof(m));
+    if (m < LOG_SQRTH) {
+        e = e - 1;
+        m = (m + m) - 1;
+    } else {
+        m = m - 1;
+    }
+    double z = m * m;
+    double y = m * (z * polyeval(LOG_P, arraycount(LOG_P), m)
+            / polyeval(LOG_Q, arraycount(LOG_Q), m));
+    y = y + e * LOG_C2;
+    y = y - .5 * z;
+    z = m + y;
+    return z + e * LOG_C1;
+}
+
+#ifdef __AVX2__
+static inline __m256d batch_polyeval(const double a[], size_t n, __m256d x)
+{
+    size_t i = n;
+    __m256d y = _mm256_set1_pd(a[--i]);
+    while (0 < i--) {
+        y = _mm256_mul_pd(y, x);
+        y = _mm256_add_pd(y, _mm256_set1_pd(a[i]));
+    }
+    return y;
+}
+
+static inline __m256d batch_log(__m256d x)
+{
+    const __m256i exponent_magic = _mm256_set1_epi64x(0x4330000000000000LL);
+    __m256i bits = _mm256_castpd_si256(x);
+    // (bits >> 52) as a double, via the mantissa of 2^52
+    __m256d e = _mm256_sub_pd(
+            _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52),
+                    exponent_magic)),
+            _mm256_set1_pd(4503599627370496.0 + 1022));
+    bits = _mm256_or_si256(
+            _mm256_and_si256(bits, _mm256_set1_epi64x(0x000fffffffffffffLL)),
+            _mm256_set1_epi64x(0x3fe0000000000000LL));
+    __m256d m = _mm256_castsi256_pd(bits);
+    const __m256d one = _mm256_set1_pd(1);
+    __m256d is_small = _mm256_cmp_pd(m, _mm256_set1_pd(LOG_SQRTH), _CMP_LT_OQ);
+    e = _mm256_sub_pd(e, _mm256_and_pd(is_small, one));
+    m = _mm256_sub_pd(_mm256_blendv_pd(m, _mm256_add_pd(m, m), is_small), one);
+    __m256d z = _mm256_mul_pd(m, m);
+    __m256d y = _mm256_mul_pd(m, _mm256_div_pd(
+                _mm256_mul_pd(z, batch_polyeval(LOG_P, arraycount(LOG_P), m)),
+                batch_polyeval(LOG_Q, arraycount(LOG_Q), m)));
+    y = _mm256_add_pd(y, _mm256_mul_pd(e, _mm256_set1_pd(LOG_C2)));
+    y = _mm256_sub_pd(y, _mm256_mul_pd(_mm256_set1_pd(.5), z));
+    z = _mm256_add_pd(m, y);
+    return _mm256_add_pd(z, _mm256_mul_pd(e, _mm256_set1_pd(LOG_C1)));
+}
+#endif
+
+void add_continuous_predictive_logps(double el, int num_clusters,
+    const double *mu_n, const double *s_n, const double *weight,
+    const double *half_nu, const double *base, double *logps)
+{
+    int cluster_idx = 0;
+#ifdef __AVX2__
+    const __m256d x = _mm256_set1_pd(el);
+    for (; cluster_idx + 4 <= num_clusters; cluster_idx += 4) {
+        __m256d delta = _mm256_sub_pd(x, _mm256_loadu_pd(mu_n + cluster_idx));
+        __m256d s_prime = _mm256_add_pd(_mm256_loadu_pd(s_n + cluster_idx),
+                _mm256_mul_pd(_mm256_loadu_pd(weight + cluster_idx),
+                    _mm256_mul_pd(delta, delta)));
+        __m256d logp = _mm256_sub_pd(_mm256_loadu_pd(base + cluster_idx),
+                _mm256_mul_pd(_mm256_loadu_pd(half_nu + cluster_idx),
+                    batch_log(s_prime)));
+        _mm256_storeu_pd(logps + cluster_idx,
+            _mm256_add_pd(_mm256_loadu_pd(logps + cluster_idx), logp));
+    }
+#endif
+    for (; cluster_idx < num_clusters; cluster_idx++) {
+        double delta = el - mu_n[cluster_idx];
+        double s_prime = s_n[cluster_idx] + weight[cluster_idx] * (delta * delta);
+        logps[cluster_idx] += base[cluster_idx]
+            - half_nu[cluster_idx] * batch_log(s_prime);
+    }
+}
+
+// log_x[i] = log(x[i]) for i < n
+static void batch_log_array(int n, const double *x, double *log_x)
+{
+    int i = 0;
+#ifdef __AVX2__
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(log_x + i, batch_log(_mm256_loadu_pd(x + i)));
+    }
+#endif
+    for (; i < n; i++) {
+        log_x[i] = batch_log(x[i]);
+    }
+}
+
+#ifdef __AVX2__
+// exp(x) for x <= 0, after the Cephes library's exp, flushing to zero
+// below EXP_MIN (where exp(x) < 1e-307 is negligible next to the
+// largest term of any logsumexp) and at -inf.  As with batch_log, the
+// scalar and AVX2 versions agree to the bit, and both are within a few
+// ulps of exp.  The scalar one only finishes off the vector loops: on
+// its own, libm's exp is faster.
+static const double EXP_P[] = {
+    9.99999999999999999910E-1,
+    3.02994407707441961300E-2,
+    1.26177193074810590878E-4,
+};
+static const double EXP_Q[] = {
+    2.00000000000000000009E0,
+    2.27265548208155028766E-1,
+    2.52448340349684104192E-3,
+    3.00198505138664455042E-6,
+};
+static const double EXP_LOG2E = 1.4426950408889634073599;
+static const double EXP_C1 = 6.93145751953125E-1;
+static const double EXP_C2 = 1.42860682030941723212E-6;
+static const double EXP_MIN = -708;
+
+static inline double batch_exp(double x)
+{
+    double c = x > EXP_MIN ? x : EXP_MIN;
+    // c = n * log(2) + r with |r| <= log(2) / 2
+    double n = floor(EXP_LOG2E * c + .5);
+    double r = c - n * EXP_C1;
+    r = r - n * EXP_C2;
+    double rr = r * r;
+    double p = r * polyeval(EXP_P, arraycount(EXP_P), rr);
+    double y = p / (polyeval(EXP_Q, arraycount(EXP_Q), rr) - p);
+    y = 1 + 2 * y;
+    // 2^n, with n + 1023 put in the exponent field via the mantissa of 2^52
+    double biased = n + (4503599627370496.0 + 1023);
+    uint64_t bits;
+    memcpy(&bits, &biased, sizeof(bits));
+    bits <<= 52;
+    double scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return x > EXP_MIN ? y * scale : 0;
+}
+
+static inline __m256d batch_exp(__m256d x)
+{
+    const __m256d exp_min = _mm256_set1_pd(EXP_MIN);
+    __m256d c = _mm256_max_pd(x, exp_min);
+    __m256d n = _mm256_floor_pd(_mm256_add_pd(
+                _mm256_mul_pd(_mm256_set1_pd(EXP_LOG2E), c),
+                _mm256_set1_pd(.5)));
+    __m256d r = _mm256_sub_pd(c, _mm256_mul_pd(n, _mm256_set1_pd(EXP_C1)));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(n, _mm256_set1_pd(EXP_C2)));
+    __m256d rr = _mm256_mul_pd(r, r);
+    __m256d p = _mm256_mul_pd(r,
+            batch_polyeval(EXP_P, arraycount(EXP_P), rr));
+    __m256d y = _mm256_div_pd(p, _mm256_sub_pd(
+                batch_polyeval(EXP_Q, arraycount(EXP_Q), rr), p));
+    y = _mm256_add_pd(_mm256_set1_pd(1), _mm256_mul_pd(_mm256_set1_pd(2), y));
+    __m256i bits = _mm256_slli_epi64(_mm256_castpd_si256(_mm256_add_pd(n,
+                    _mm256_set1_pd(4503599627370496.0 + 1023))), 52);
+    y = _mm256_mul_pd(y, _mm256_castsi256_pd(bits));
+    return _mm256_and_pd(y, _mm256_cmp_pd(x, exp_min, _CMP_GT_OQ));
+}
+#endif
+
+// sum_i exp(x[i] - shift) for i < n
+static double sum_exp_shifted(const double *x, int n, double shift)
+{
+    int i = 0;
+    double total = 0;
+#ifdef __AVX2__
+    const __m256d shift_4 = _mm256_set1_pd(shift);
+    __m256d acc = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_add_pd(acc,
+                batch_exp(_mm256_sub_pd(_mm256_loadu_pd(x + i), shift_4)));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; i++) {
+        total += batch_exp(x[i] - shift);
+    }
+#else
+    for (; i < n; i++) {
+        total += exp(x[i] - shift);
+    }
+#endif
+    return total;
+}
+
+double logsumexp(const double *x, int n)
+{
+    if (n == 0) {
+        return -HUGE_VAL;
+    }
+    double maximum = *std::max_element(x, x + n);
+    // all -inf, or a +inf (or nan) that dominates
+    if (!(fabs(maximum) < HUGE_VAL)) {
+        return maximum;
+    }
+    return log(sum_exp_shifted(x, n, maximum)) + maximum;
+}
+
+void logsumexp_rows(const double *x, int num_rows, int num_cols,
+    double *out)
+{
+    for (int row_idx = 0; row_idx < num_rows; row_idx++) {
+        out[row_idx] = logsumexp(x + row_idx * num_cols, num_cols);
+    }
+}
+
+OnlineLogSumExp::OnlineLogSumExp() : maximum(-HUGE_VAL), sum(0)
+{
+}
+
+void OnlineLogSumExp::add(double x)
+{
+    if (x == -HUGE_VAL) {
+        return;
+    }
+    if (x <= maximum) {
+        sum += exp(x - maximum);
+    } else {
+        // rescale what we have to the new maximum
+        sum = sum * exp(maximum - x) + 1;
+        maximum = x;
+    }
+}
+
+double OnlineLogSumExp::get() const
+{
+    return sum == 0 ? -HUGE_VAL : log(sum) + maximum;
+}
+
+vector<double> calc_continuous_hyper_conditionals(HyperId which_hyper,
+    const vector<double> &hyper_grid,
+    int num_clusters, const int *count,
+    const double *sum_x, const double *sum_x_sq,
+    double r, double nu, double s, double mu)
+{
+    assert(which_hyper == HYPER_R || which_hyper == HYPER_NU
+        || which_hyper == HYPER_S || which_hyper == HYPER_MU);
+    int num_grid = hyper_grid.size();
+    vector<double> r_grid(num_grid, r);
+    vector<double> nu_grid(num_grid, nu);
+    vector<double> s_grid(num_grid, s);
+    vector<double> mu_grid(num_grid, mu);
+    switch (which_hyper) {
+    case HYPER_R: r_grid = hyper_grid; break;
+    case HYPER_NU: nu_grid = hyper_grid; break;
+    case HYPER_S: s_grid = hyper_grid; break;
+    default: mu_grid = hyper_grid; break;
+    }
+    // the prior's normalizer depends only on the grid point
+    vector<double> log_Z_0(num_grid);
+    for (int grid_idx = 0; grid_idx < num_grid; grid_idx++) {
+        log_Z_0[grid_idx] = calc_continuous_log_Z(r_grid[grid_idx],
+                nu_grid[grid_idx], s_grid[grid_idx]);
+    }
+    vector<double> logps(num_grid, 0);
+    vector<double> r_n(num_grid), log_r_n(num_grid);
+    vector<double> s_n(num_grid), log_s_n(num_grid);
+    for (int cluster_idx = 0; cluster_idx < num_clusters; cluster_idx++) {
+        int c = count[cluster_idx];
+        double sx = sum_x[cluster_idx];
+        double sxx = sum_x_sq[cluster_idx];
+        for (int grid_idx = 0; grid_idx < num_grid; grid_idx++) {
+            double r_0 = r_grid[grid_idx];
+            double mu_0 = mu_grid[grid_idx];
+            double r_prime = r_0 + c;
+            double mu_prime = ((r_0 * mu_0) + sx) / r_prime;
+            r_n[grid_idx] = r_prime;
+            s_n[grid_idx] = s_grid[grid_idx] + sxx + (r_0 * mu_0 * mu_0)
+                - (r_prime * mu_prime * mu_prime);
+        }
+        batch_log_array(num_grid, &s_n[0], &log_s_n[0]);
+        // r_n and nu_n only vary over the grid when it is theirs
+        if (which_hyper == HYPER_R) {
+            batch_log_array(num_grid, &r_n[0], &log_r_n[0]);
+        } else {
+            std::fill(log_r_n.begin(), log_r_n.end(), log(r + c));
+        }
+        double lgamma_half_nu_n = log_gamma(.5 * (nu + c));
+        double data_term = -c * HALF_LOG_2PI;
+        for (int grid_idx = 0; grid_idx < num_grid; grid_idx++) {
+            double half_nu_n = .5 * (nu_grid[grid_idx] + c);
+            double log_Z_n = half_nu_n * (LOG_2 - log_s_n[grid_idx])
+                + HALF_LOG_2PI
+                - .5 * log_r_n[grid_idx]
+                + (which_hyper == HYPER_NU ? log_gamma(half_nu_n)
+                    : lgamma_half_nu_n);
+            log_Z_n += calc_continuous_hyperprior(r_n[grid_idx],
+                    2 * half_nu_n, s_n[grid_idx]);
+            logps[grid_idx] += data_term + log_Z_n - log_Z_0[grid_idx];
+        }
+    }
+    return logps;
+}
+
 vector<double> calc_continuous_r_conditionals(const vector<double> &r_grid,
     int count,
     double sum_x,
@@ -669,16 +1157,42 @@ double calc_multinomial_marginal_logp(int count,
     double sum_lgammas = 0;
     for (size_t key = 0; key < counts.size(); key++) {
         int label_count = counts[key];
-        sum_lgammas += lgamma(label_count + dirichlet_alpha);
+        sum_lgammas += log_gamma(label_count + dirichlet_alpha);
+    }
+    int missing_labels = K - counts.size();
+    if (missing_labels != 0) {
+        sum_lgammas += missing_labels * log_gamma(dirichlet_alpha);
+    }
+    double marginal_logp = log_gamma(K * dirichlet_alpha)  \
+        - K * log_gamma(dirichlet_alpha)     \
+        + sum_lgammas             \
+        - log_gamma(count + K * dirichlet_alpha);
+    return marginal_logp;
+}
+
+double calc_multinomial_marginal_logp(int count,
+    const vector<int> &counts,
+    int K,
+    double dirichlet_alpha,
+    LgammaTable &lgamma_table)
+{
+    double sum_lgammas = 0;
+    for (size_t key = 0; key < counts.size(); key++) {
+        int label_count = counts[key];
+        sum_lgammas += lgamma_table.lgamma_shifted(label_count,
+                dirichlet_alpha);
     }
+    double lgamma_alpha = lgamma_table.lgamma_shifted(0, dirichlet_alpha);
     int missing_labels = K - counts.size();
     if (missing_labels != 0) {
-        sum_lgammas += missing_labels * lgamma(dirichlet_alpha);
+        sum_lgammas += missing_labels * lgamma_alpha;
     }
-    double marginal_logp = lgamma(K * dirichlet_alpha)  \
-        - K * lgamma(dirichlet_alpha)     \
+    double K_alpha = K * dirichlet_alpha;
+    // count is the cluster size, too large to tabulate per grid value
+    double marginal_logp = lgamma_table.lgamma_shifted(0, K_alpha)  \
+        - K * lgamma_alpha     \
         + sum_lgammas             \
-        - lgamma(count + K * dirichlet_alpha);
+        - log_gamma(count + K_alpha);
     return marginal_logp;
 }
 
@@ -717,6 +1231,25 @@ vector<double> calc_multinomial_dirichlet_alpha_conditional(
     return logps;
 }
 
+vector<double> calc_multinomial_dirichlet_alpha_conditional(
+    const vector<double> &dirichlet_alpha_grid,
+    int count,
+    const vector<int> &counts,
+    int K,
+    LgammaTable &lgamma_table)
+{
+    vector<double> logps;
+    vector<double>::const_iterator it;
+    for (it = dirichlet_alpha_grid.begin(); it != dirichlet_alpha_grid.end();
+        it++) {
+        double dirichlet_alpha = *it;
+        double logp = calc_multinomial_marginal_logp(count, counts, K,
+                dirichlet_alpha, lgamma_table);
+        logps.push_back(logp);
+    }
+    return logps;
+}
+
 
 // Cyclic component model
 void insert_to_cyclic_suffstats(int &count,
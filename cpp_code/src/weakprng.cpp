@@ -327,6 +327,20 @@ crypto_weakprng_seed(struct crypto_weakprng *P, const void *seed)
 	memcpy(P->key, seed, crypto_weakprng_SEEDBYTES);
 }
 
+/*
+ * Increment the 64-bit nonce.  Overflow is not a concern: if we
+ * generated a block every nanosecond, it would take >584 years to
+ * reach 2^64.
+ */
+static void
+crypto_weakprng_advance(struct crypto_weakprng *P)
+{
+
+	le32enc(&P->nonce[0], 1 + le32dec(&P->nonce[0]));
+	if (le32dec(&P->nonce[0]) == 0)
+		le32enc(&P->nonce[1], 1 + le32dec(&P->nonce[1]));
+}
+
 uint32_t
 crypto_weakprng_32(struct crypto_weakprng *P)
 {
@@ -344,14 +358,7 @@ crypto_weakprng_32(struct crypto_weakprng *P)
 	crypto_core((uint8_t *)P->buffer, (const uint8_t *)P->nonce,
 	    (const uint8_t *)P->key, crypto_core_constant32);
 
-	/*
-	 * Increment the 64-bit nonce.  Overflow is not a concern: if
-	 * we generated a block every nanosecond, it would take >584
-	 * years to reach 2^64.
-	 */
-	le32enc(&P->nonce[0], 1 + le32dec(&P->nonce[0]));
-	if (le32dec(&P->nonce[0]) == 0)
-		le32enc(&P->nonce[1], 1 + le32dec(&P->nonce[1]));
+	crypto_weakprng_advance(P);
 
 	/*
 	 * Extract the last 32-bit word and use its place to count the
@@ -377,10 +384,33 @@ crypto_weakprng_64(struct crypto_weakprng *P)
 void
 crypto_weakprng_buf(struct crypto_weakprng *P, void *buf, size_t len)
 {
+	const unsigned ii = arraycount(P->buffer) - 1;
 	uint8_t *p = (uint8_t *)buf;
 	uint32_t u32;
 	unsigned n32, n8;
 
+	/* Use up any buffered words.  */
+	while (len >= 4 && P->buffer[ii]) {
+		u32 = crypto_weakprng_32(P);
+		le32enc(p, u32);
+		p += 4;
+		len -= 4;
+	}
+
+	/*
+	 * Generate whole blocks straight into the caller's buffer.
+	 * They come out in keystream order rather than the word order
+	 * crypto_weakprng_32 disburses, which is just as uniform and
+	 * saves a copy and a branch per word for bulk requests.
+	 */
+	while (len >= crypto_core_OUTPUTBYTES) {
+		crypto_core(p, (const uint8_t *)P->nonce,
+		    (const uint8_t *)P->key, crypto_core_constant32);
+		crypto_weakprng_advance(P);
+		p += crypto_core_OUTPUTBYTES;
+		len -= crypto_core_OUTPUTBYTES;
+	}
+
 	/* Fill as many full 32-bit words as we can.  */
 	n32 = len / 4;
 	while (n32--) {
@@ -432,3 +462,31 @@ crypto_weakprng_below(struct crypto_weakprng *P, uintmax_t bound)
 
 	return r % bound;
 }
+
+/*
+ * Independent streams.  The block counter occupies the low 64 bits of
+ * the ChaCha8 input and the high 64 bits are always zero in the
+ * parent's own output, so evaluating ChaCha8 under the parent's key
+ * on an input with a nonzero high half yields blocks the parent never
+ * disburses.  The child's key is such a block, indexed by the stream
+ * id: it depends only on the parent's key and the id, not on how much
+ * of the parent's stream has been consumed, so streams can be split
+ * off in any order, on any thread, and agree from run to run.
+ */
+void
+crypto_weakprng_split(const struct crypto_weakprng *P,
+    struct crypto_weakprng *C, uint64_t id)
+{
+	uint8_t in[crypto_core_INPUTBYTES];
+	uint8_t block[crypto_core_OUTPUTBYTES];
+
+	le32enc(in + 0, id & 0xffffffff);
+	le32enc(in + 4, id >> 32);
+	le32enc(in + 8, 1);
+	le32enc(in + 12, 0);
+	crypto_core(block, in, (const uint8_t *)P->key,
+	    crypto_core_constant32);
+
+	CTASSERT(crypto_weakprng_SEEDBYTES <= sizeof block);
+	crypto_weakprng_seed(C, block);
+}
@@ -0,0 +1,64 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <cmath>
+#include <cassert>
+#include <vector>
+
+#include "ChainEnsemble.h"
+#include "test_support.h"
+
+using namespace std;
+
+// every chain matches a standalone State with the same seed, whatever the
+// number of threads
+static void test_transition(int num_threads) {
+    vector<string> col_datatypes;
+    vector<int> multinomial_counts;
+    MatrixD data = mixed_data(40, 3, col_datatypes, multinomial_counts);
+    vector<int> row_indices = create_sequence(40);
+    vector<int> col_indices = create_sequence(3);
+    vector<int> seeds;
+    seeds.push_back(0);
+    seeds.push_back(7);
+    seeds.push_back(11);
+    ChainEnsemble ensemble(data, col_datatypes, multinomial_counts,
+        row_indices, col_indices, seeds);
+    ensemble.set_num_threads(num_threads);
+    assert(ensemble.get_num_chains() == 3);
+    assert(ensemble.get_num_threads() == num_threads);
+    vector<double> score_deltas = ensemble.transition(data, 3);
+    assert(score_deltas.size() == seeds.size());
+    for (size_t chain_idx = 0; chain_idx < seeds.size(); chain_idx++) {
+        State s(data, col_datatypes, multinomial_counts, row_indices,
+            col_indices, FROM_THE_PRIOR, "", empty_vector_double,
+            empty_vector_double, empty_vector_double, empty_vector_double,
+            31, seeds[chain_idx]);
+        double score_delta = 0;
+        for (int step_idx = 0; step_idx < 3; step_idx++) {
+            score_delta += s.transition(data);
+        }
+        State &chain = ensemble.get_chain(chain_idx);
+        assert(score_delta == score_deltas[chain_idx]);
+        assert(s.get_marginal_logp() == chain.get_marginal_logp());
+        assert(s.get_X_D() == chain.get_X_D());
+    }
+}
+
+int main(int argc, char **argv) {
+    test_transition(1);
+    test_transition(3);
+    return 0;
+}
@@ -232,6 +232,20 @@ int main(int argc, char** argv) {
     //
     assert(is_almost(sum_scores, cd.calc_sum_marginal_logps(), 1E-10));
 
+    // test that a reset, emptied cluster scores like a fresh one, hyper
+    // updates it missed included
+    cout << "Resetting emptied cluster" << endl;
+    (*hypers_v[0])["s"] = 2 * s0_0;
+    cd.reset();
+    Cluster fresh(hypers_v);
+    assert(cd.get_marginal_logp() == fresh.get_marginal_logp());
+    assert(cd.calc_sum_marginal_logps() == fresh.calc_sum_marginal_logps());
+    assert(cd.calc_row_predictive_logp(rows[0])
+        == fresh.calc_row_predictive_logp(rows[0]));
+    fresh.delete_component_models();
+    (*hypers_v[0])["s"] = s0_0;
+    cd.reset();
+
     // test ability to remove columns
     //
     // poplute the cluster object
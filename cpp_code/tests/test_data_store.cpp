@@ -0,0 +1,116 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <cassert>
+#include <vector>
+
+#include "DataStore.h"
+#include "Matrix.h"
+#include "test_support.h"
+
+using namespace std;
+
+static void test_get_value(void) {
+    MatrixD data = indexed_data(5, 3);
+    DataStore store(data);
+    assert(store.get_num_rows() == 5);
+    assert(store.get_num_cols() == 3);
+    for (int row_idx = 0; row_idx < 5; row_idx++) {
+        for (int col_idx = 0; col_idx < 3; col_idx++) {
+            assert(store.get_value(row_idx, col_idx) == data(row_idx, col_idx));
+        }
+    }
+}
+
+static void test_get_row_and_column(void) {
+    DataStore store(indexed_data(4, 3));
+    vector<int> col_indices;
+    col_indices.push_back(2);
+    col_indices.push_back(0);
+    vector<double> row_data(7, -1);
+    store.get_row(3, col_indices, row_data);
+    assert(row_data.size() == 2);
+    assert(row_data[0] == 32);
+    assert(row_data[1] == 30);
+
+    vector<double> col_data = store.get_column(1);
+    assert(col_data.size() == 4);
+    for (int row_idx = 0; row_idx < 4; row_idx++) {
+        assert(col_data[row_idx] == 10 * row_idx + 1);
+    }
+
+    vector<vector<double> > cols = store.get_columns(col_indices);
+    assert(cols.size() == 2);
+    assert(cols[0] == store.get_column(2));
+    assert(cols[1] == store.get_column(0));
+}
+
+static void test_append_row(void) {
+    DataStore store(indexed_data(2, 2));
+    vector<double> new_row;
+    new_row.push_back(-1);
+    new_row.push_back(-2);
+    store.append_row(new_row);
+    assert(store.get_num_rows() == 3);
+    assert(store.get_value(2, 0) == -1);
+    assert(store.get_value(2, 1) == -2);
+    vector<double> col_data = store.get_column(1);
+    assert(col_data.size() == 3);
+    assert(col_data[0] == 1);
+    assert(col_data[1] == 11);
+    assert(col_data[2] == -2);
+}
+
+static void test_borrow_column_major_view(void) {
+    // 3 x 2, column by column
+    double values[] = {0, 10, 20, 1, 11, 21};
+    MatrixD view(values, 3, 2, true);
+    assert(view.get_column_major_view_data() == values);
+    DataStore store(view);
+    for (int row_idx = 0; row_idx < 3; row_idx++) {
+        for (int col_idx = 0; col_idx < 2; col_idx++) {
+            assert(store.get_value(row_idx, col_idx) == view(row_idx, col_idx));
+        }
+    }
+    // read in place, not copied
+    values[1] = -5;
+    assert(store.get_value(1, 0) == -5);
+
+    vector<double> new_row;
+    new_row.push_back(30);
+    new_row.push_back(31);
+    store.append_row(new_row);
+    vector<double> col_data = store.get_column(1);
+    assert(col_data.size() == 4);
+    assert(col_data[2] == 21);
+    assert(col_data[3] == 31);
+
+    // a row-major view or an owning matrix is copied
+    MatrixD row_major(values, 2, 3, false);
+    assert(row_major.get_column_major_view_data() == NULL);
+    assert(indexed_data(3, 2).get_column_major_view_data() == NULL);
+}
+
+int main(int argc, char **argv) {
+    test_get_value();
+    test_get_row_and_column();
+    test_append_row();
+    test_borrow_column_major_view();
+    return 0;
+}
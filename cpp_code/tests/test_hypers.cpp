@@ -0,0 +1,102 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "ContinuousComponentModel.h"
+#include "CyclicComponentModel.h"
+#include "Hypers.h"
+#include "MultinomialComponentModel.h"
+#include "utils.h"
+
+using namespace std;
+
+#define arraycount(A) (sizeof(A)/sizeof(*(A)))
+
+static void test_names(void) {
+    for (int i = 0; i < NUM_HYPER_IDS; i++) {
+        HyperId hyper_id = static_cast<HyperId>(i);
+        assert(get_hyper_id(get_hyper_name(hyper_id)) == hyper_id);
+    }
+    assert(get_hyper_name(HYPER_R) == "r");
+    assert(get_hyper_name(HYPER_DIRICHLET_ALPHA) == "dirichlet_alpha");
+    assert(get_hyper_id("kappa") == HYPER_KAPPA);
+}
+
+// set which_hyper in hypers and update cm_typed with the typed path and
+// cm_map by re-reading the map; both must agree exactly
+static void check_update(ComponentModel &cm_typed, ComponentModel &cm_map,
+    CM_Hypers &hypers, HyperId which_hyper, double value) {
+    hypers[get_hyper_name(which_hyper)] = value;
+    double delta_typed = cm_typed.incorporate_hyper_update(which_hyper, value);
+    double delta_map = cm_map.incorporate_hyper_update();
+    assert(delta_typed == delta_map);
+    assert(cm_typed.calc_marginal_logp() == cm_map.calc_marginal_logp());
+    assert(cm_typed.calc_element_predictive_logp(1)
+        == cm_map.calc_element_predictive_logp(1));
+    vector<double> grid = linspace(0.5, 2.5, 5);
+    assert(cm_typed.calc_hyper_conditionals(which_hyper, grid)
+        == cm_map.calc_hyper_conditionals(get_hyper_name(which_hyper), grid));
+}
+
+static void test_typed_updates(void) {
+    const double data[] = {1.5, 0.25, 2, 3.75, 1};
+    CM_Hypers continuous_hypers, cyclic_hypers, multinomial_hypers;
+    continuous_hypers["r"] = 1;
+    continuous_hypers["nu"] = 2;
+    continuous_hypers["s"] = 3;
+    continuous_hypers["mu"] = 0;
+    cyclic_hypers["kappa"] = 1;
+    cyclic_hypers["a"] = 2;
+    cyclic_hypers["b"] = 1;
+    multinomial_hypers["K"] = 4;
+    multinomial_hypers["dirichlet_alpha"] = 1;
+    ContinuousComponentModel continuous_typed(continuous_hypers);
+    ContinuousComponentModel continuous_map(continuous_hypers);
+    CyclicComponentModel cyclic_typed(cyclic_hypers);
+    CyclicComponentModel cyclic_map(cyclic_hypers);
+    MultinomialComponentModel multinomial_typed(multinomial_hypers);
+    MultinomialComponentModel multinomial_map(multinomial_hypers);
+    for (size_t i = 0; i < arraycount(data); i++) {
+        continuous_typed.insert_element(data[i]);
+        continuous_map.insert_element(data[i]);
+        cyclic_typed.insert_element(data[i]);
+        cyclic_map.insert_element(data[i]);
+        multinomial_typed.insert_element(trunc(data[i]));
+        multinomial_map.insert_element(trunc(data[i]));
+    }
+    check_update(continuous_typed, continuous_map, continuous_hypers,
+        HYPER_R, 0.5);
+    check_update(continuous_typed, continuous_map, continuous_hypers,
+        HYPER_NU, 4);
+    check_update(continuous_typed, continuous_map, continuous_hypers,
+        HYPER_S, 0.75);
+    check_update(continuous_typed, continuous_map, continuous_hypers,
+        HYPER_MU, -1);
+    check_update(cyclic_typed, cyclic_map, cyclic_hypers, HYPER_KAPPA, 2);
+    check_update(cyclic_typed, cyclic_map, cyclic_hypers, HYPER_A, 0.5);
+    check_update(cyclic_typed, cyclic_map, cyclic_hypers, HYPER_B, 3);
+    check_update(multinomial_typed, multinomial_map, multinomial_hypers,
+        HYPER_DIRICHLET_ALPHA, 0.25);
+}
+
+int main(int argc, char** argv) {
+    test_names();
+    test_typed_updates();
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "LgammaTable.h"
+#include "numerics.h"
+#include "utils.h"
+
+using namespace std;
+
+static void test_lgamma_shifted(void) {
+    LgammaTable table;
+    assert(table.get_num_offsets() == 0);
+    // out of order, so entries are filled sparsely
+    assert(table.lgamma_shifted(7, 0.25) == lgamma(7 + 0.25));
+    assert(table.lgamma_shifted(0, 0.25) == lgamma(0.25));
+    assert(table.lgamma_shifted(3, 0.25) == lgamma(3 + 0.25));
+    assert(table.lgamma_shifted(7, 0.25) == lgamma(7 + 0.25));
+    assert(table.lgamma_shifted(1, 0) == 0);
+    assert(table.lgamma_shifted(100, 1e-3) == lgamma(100 + 1e-3));
+    // past the tabulated range, computed directly
+    int big_n = 2000000;
+    assert(table.lgamma_shifted(big_n, 0.25) == lgamma(big_n + 0.25));
+    assert(table.lgamma_shifted(LgammaTable::MAX_TABLE_N, 0.25)
+        == lgamma(LgammaTable::MAX_TABLE_N + 0.25));
+    assert(table.get_num_offsets() == 3);
+    table.clear();
+    assert(table.get_num_offsets() == 0);
+}
+
+static void test_crp_and_multinomial(void) {
+    LgammaTable table;
+    vector<int> counts;
+    counts.push_back(5);
+    counts.push_back(1);
+    counts.push_back(12);
+    int sum_counts = 18;
+    vector<double> grid = log_linspace(1. / sum_counts, sum_counts, 10);
+    // twice: filling the table, then reading it
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t i = 0; i < grid.size(); i++) {
+            double alpha = grid[i];
+            assert(numerics::calc_crp_alpha_conditional(counts, alpha,
+                    sum_counts, true, table)
+                == numerics::calc_crp_alpha_conditional(counts, alpha,
+                    sum_counts, true));
+            assert(numerics::calc_crp_alpha_conditional(counts, alpha, -1,
+                    false, table)
+                == numerics::calc_crp_alpha_conditional(counts, alpha));
+        }
+        double sum_log_gammas = lgamma(5) + lgamma(1) + lgamma(12);
+        for (size_t i = 0; i < grid.size(); i++) {
+            double expected = numerics::calc_crp_alpha_conditional(counts,
+                    grid[i], sum_counts, true);
+            double actual = numerics::calc_crp_alpha_conditional(
+                    counts.size(), sum_counts, sum_log_gammas, grid[i], table);
+            assert(fabs(expected - actual) < 1e-12 * fabs(expected));
+        }
+        int K = 4;
+        assert(numerics::calc_multinomial_dirichlet_alpha_conditional(grid,
+                sum_counts, counts, K, table)
+            == numerics::calc_multinomial_dirichlet_alpha_conditional(grid,
+                sum_counts, counts, K));
+    }
+}
+
+int main(int argc, char** argv) {
+    test_lgamma_shifted();
+    test_crp_and_multinomial();
+
+    return 0;
+}
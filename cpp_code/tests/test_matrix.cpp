@@ -70,6 +70,28 @@ int main(int argc, char **argv) {
 	}
     }
 
+    // Confirm views read the buffer in place, in either order.
+    double values[6] = {0, 1, 2, 3, 4, 5};
+    MatrixD row_major(values, 2, 3, false);
+    MatrixD column_major(values, 2, 3, true);
+    assert(row_major.size1() == 2);
+    assert(row_major.size2() == 3);
+    assert(row_major(1, 0) == 3);
+    assert(column_major(1, 0) == 1);
+    assert(column_major(0, 2) == 4);
+    values[5] = 7;
+    assert(&row_major(1, 2) == &values[5]);
+    assert(column_major(1, 2) == 7);
+
+    // Confirm copying a view makes an independent matrix.
+    MatrixD column_major_copy = column_major;
+    values[5] = 5;
+    for (i = 0; i < 2; i++) {
+	for (j = 0; j < 3; j++) {
+	    assert(column_major_copy(i, j) == (i == 1 && j == 2 ? 7 : j * 2 + i));
+	}
+    }
+
     // Confirm MatrixD = matrix<double> by confirming the pointer
     // types are compatible.
     matrix<double> MD0(42, 42);
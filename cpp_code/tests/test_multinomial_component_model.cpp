@@ -161,6 +161,24 @@ int main() {
     // cout << "draws are: " << draws << endl;
     cout << "draw_counts is: " << draw_counts << endl;
 
+    cout << "test bulk draws" << endl;
+    vector<double> bulk_draws = mcm.get_draws(rng.nexti(), num_draws);
+    assert((int) bulk_draws.size() == num_draws);
+    map<double, int> bulk_draw_counts;
+    for (int i = 0; i < num_draws; i++) {
+        bulk_draw_counts[bulk_draws[i]]++;
+    }
+    cout << "bulk_draw_counts is: " << bulk_draw_counts << endl;
+    // both are within a few standard errors (< .005) of the predictive
+    map<double, int>::const_iterator count_it;
+    for (count_it = draw_counts.begin(); count_it != draw_counts.end();
+        ++count_it) {
+        double frequency = count_it->second / (double) num_draws;
+        double bulk_frequency =
+            bulk_draw_counts[count_it->first] / (double) num_draws;
+        assert(fabs(frequency - bulk_frequency) < .04);
+    }
+
 
     cout << endl << endl << "test constructor with sparse input" << endl;
     // elements to add
@@ -18,6 +18,7 @@
 #include <limits>
 
 #include "numerics.h"
+#include "RandomNumberGenerator.h"
 #include "utils.h"
 
 using namespace std;
@@ -60,6 +61,56 @@ static void test_draw(void) {
       weights.size());
 }
 
+static void test_draw_scratch(void) {
+    using numerics::draw_sample_unnormalized;
+    const double epsilon = std::numeric_limits<double>::epsilon();
+
+    vector<double> weights(5), scratch;
+    weights[0] = log(1);
+    weights[1] = log(2);
+    weights[2] = -HUGE_VAL;
+    weights[3] = log(4);
+    weights[4] = log(3);
+    // the scratch version partitions [0, 1] the same way, away from the
+    // boundaries where the two may round differently
+    for (size_t i = 0; i < 1000; i++) {
+        const double u = (i + .5) / 1000;
+        const int draw = draw_sample_unnormalized(weights, u, scratch);
+        assert(draw != 2);
+        assert(draw == draw_sample_unnormalized(weights, u));
+    }
+    assert(draw_sample_unnormalized(weights, 0, scratch) == 0);
+    assert(draw_sample_unnormalized(weights, 1 - epsilon/2, scratch) == 4);
+    assert(draw_sample_unnormalized(weights, 1, scratch) == 4);
+}
+
+static void test_alias(void) {
+    vector<double> weights(5);
+    weights[0] = log(1);
+    weights[1] = log(2);
+    weights[2] = -HUGE_VAL;
+    weights[3] = log(4);
+    weights[4] = log(3);
+    const double total = 10;
+
+    vector<double> alias_probs;
+    vector<int> aliases;
+    numerics::build_alias_table(weights, alias_probs, aliases);
+
+    // a uniform sweep over [0, 1) recovers the weights
+    const size_t num_darts = 100000;
+    vector<size_t> counts(weights.size());
+    for (size_t i = 0; i < num_darts; i++) {
+        const double u = (i + .5) / num_darts;
+        counts[numerics::draw_sample_alias(alias_probs, aliases, u)]++;
+    }
+    assert(counts[2] == 0);
+    for (size_t i = 0; i < weights.size(); i++) {
+        const double expected = exp(weights[i]) / total;
+        assert(fabs(counts[i] / (double) num_darts - expected) < 1e-4);
+    }
+}
+
 static void test_linspace(void) {
     vector<double> v;
 
@@ -126,6 +177,64 @@ static void test_logaddexp(void) {
 
 #define arraycount(A) (sizeof(A)/sizeof(*(A)))
 
+// the two-pass std::exp logsumexp that logaddexp used to be
+static double reference_logsumexp(const double *x, int n) {
+    const double maximum = *std::max_element(x, x + n);
+    double result = 0;
+    for (int i = 0; i < n; i++)
+        result += exp(x[i] - maximum);
+    return log(result) + maximum;
+}
+
+static void test_logsumexp(void) {
+    RandomNumberGenerator rng(19);
+    const double scales[] = {1e-3, 1, 30, 700, 1e4};
+
+    for (size_t scale_idx = 0; scale_idx < 5; scale_idx++) {
+        for (int n = 1; n < 40; n++) {
+            vector<double> x(n);
+            for (int i = 0; i < n; i++)
+                x[i] = scales[scale_idx] * (2 * rng.next() - 1);
+            if (n % 5 == 0)
+                x[n / 2] = -HUGE_VAL;
+            const double expected = reference_logsumexp(&x[0], n);
+            const double actual = numerics::logsumexp(&x[0], n);
+            assert(fabs(actual - expected)
+                <= 1e-14 * std::max(1., fabs(expected)));
+
+            numerics::OnlineLogSumExp online;
+            for (int i = 0; i < n; i++)
+                online.add(x[i]);
+            assert(fabs(online.get() - expected)
+                <= 1e-14 * std::max(1., fabs(expected)));
+        }
+    }
+
+    // exact cases and the edges
+    vector<double> x(8, log(.125));
+    assert(fabs(numerics::logsumexp(&x[0], 8)) < 1e-15);
+    assert(numerics::logsumexp(&x[0], 0) == -HUGE_VAL);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = -HUGE_VAL;
+    assert(numerics::logsumexp(&x[0], 8) == -HUGE_VAL);
+    assert(numerics::OnlineLogSumExp().get() == -HUGE_VAL);
+    x[3] = HUGE_VAL;
+    assert(numerics::logsumexp(&x[0], 8) == HUGE_VAL);
+    x[3] = -1e300;
+    assert(numerics::logsumexp(&x[0], 8) == -1e300);
+
+    // rows of a 3 x 7 matrix, one of them all -inf
+    vector<double> m(21), rows(3);
+    for (size_t i = 0; i < m.size(); i++)
+        m[i] = 10 * rng.next();
+    for (size_t i = 7; i < 14; i++)
+        m[i] = -HUGE_VAL;
+    numerics::logsumexp_rows(&m[0], 3, 7, &rows[0]);
+    assert(rows[0] == numerics::logsumexp(&m[0], 7));
+    assert(rows[1] == -HUGE_VAL);
+    assert(rows[2] == numerics::logsumexp(&m[14], 7));
+}
+
 static void test_bessel(void) {
     static const double i0e[][2] = {
         // Uniform [-709, +709] grid
@@ -756,12 +865,84 @@ static void test_bessel(void) {
     }
 }
 
+static void test_continuous_predictive_logps(void) {
+    using numerics::add_continuous_predictive_logps;
+    using numerics::calc_continuous_predictive_terms;
+    const double epsilon = std::numeric_limits<double>::epsilon();
+    const double r = 1.5, nu = 2.5, s = 3.5, mu = -0.5;
+    const double log_Z_0 = numerics::calc_continuous_logp(0, r, nu, s, 0);
+    // enough clusters to fill a vector and leave a scalar tail; clusters
+    // 1 and 5 have identical suffstats
+    const double data[] = {0.25, -1.75, 4.0, 1e-3, 12.5, -7.0, 2.0};
+    const int num_clusters = 7;
+    vector<int> count(num_clusters, 0);
+    vector<double> sum_x(num_clusters, 0), sum_x_sq(num_clusters, 0);
+    vector<double> score(num_clusters, 0);
+    vector<double> mu_n(num_clusters), s_n(num_clusters),
+        weight(num_clusters), half_nu(num_clusters), base(num_clusters);
+    int k;
+
+    for (k = 0; k < num_clusters; k++) {
+        int num_elements = k == 5 ? 1 : k;
+        for (int i = 0; i < num_elements; i++) {
+            numerics::insert_to_continuous_suffstats(count[k], sum_x[k],
+                sum_x_sq[k], data[i]);
+        }
+        double r_n = r, nu_n = nu, s_n_k = s, mu_n_k = mu;
+        numerics::update_continuous_hypers(count[k], sum_x[k], sum_x_sq[k],
+            r_n, nu_n, s_n_k, mu_n_k);
+        score[k] = numerics::calc_continuous_logp(count[k], r_n, nu_n,
+                s_n_k, log_Z_0);
+        calc_continuous_predictive_terms(count[k], sum_x[k], sum_x_sq[k],
+            r, nu, s, mu, log_Z_0, score[k],
+            mu_n[k], s_n[k], weight[k], half_nu[k], base[k]);
+    }
+
+    for (size_t i = 0; i < arraycount(data); i++) {
+        vector<double> logps(num_clusters, 1);
+        add_continuous_predictive_logps(data[i], num_clusters, &mu_n[0],
+            &s_n[0], &weight[0], &half_nu[0], &base[0], &logps[0]);
+        for (k = 0; k < num_clusters; k++) {
+            int count_prime = count[k];
+            double sum_x_prime = sum_x[k], sum_x_sq_prime = sum_x_sq[k];
+            numerics::insert_to_continuous_suffstats(count_prime,
+                sum_x_prime, sum_x_sq_prime, data[i]);
+            double r_n = r, nu_n = nu, s_n_k = s, mu_n_k = mu;
+            numerics::update_continuous_hypers(count_prime, sum_x_prime,
+                sum_x_sq_prime, r_n, nu_n, s_n_k, mu_n_k);
+            double expected = 1 + numerics::calc_continuous_logp(count_prime,
+                    r_n, nu_n, s_n_k, log_Z_0) - score[k];
+            assert(fabs(expected - logps[k]) < 1e3*epsilon*(1 + fabs(expected)));
+        }
+        // the vector and scalar paths agree to the bit
+        assert(logps[1] == logps[5]);
+    }
+
+    // with weight 0, half_nu -1 and base 0 the kernel adds log(s_n)
+    const double xs[] = {1e-300, 1e-5, 0.5, 0.70710678118654752440, 1, 2,
+        3.14159, 1e5, 1e300};
+    const int num_xs = arraycount(xs);
+    vector<double> zeros(num_xs, 0), minus_halves(num_xs, -1);
+    vector<double> s_xs(xs, xs + num_xs), logs(num_xs, 0);
+    add_continuous_predictive_logps(0, num_xs, &zeros[0], &s_xs[0],
+        &zeros[0], &minus_halves[0], &zeros[0], &logs[0]);
+    for (k = 0; k < num_xs; k++) {
+        double expected = log(xs[k]);
+        assert(expected == 0 ? logs[k] == 0
+            : relerr(logs[k], expected) < 4*epsilon);
+    }
+}
+
 int main(int argc, char** argv) {
     test_draw();
+    test_draw_scratch();
+    test_alias();
     test_linspace();
     test_log_linspace();
     test_logaddexp();
+    test_logsumexp();
     test_bessel();
+    test_continuous_predictive_logps();
 
     return 0;
 }
@@ -19,6 +19,7 @@
 #include <cmath>
 #include <fstream>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include "RandomNumberGenerator.h"
@@ -408,15 +409,15 @@ static void cdf_bins(double (*F)(double), double lo, double hi,
     probabilities[probabilities.size() - 1] = 1 - F(x0);
 }
 
-static void sample_bins(const sampler &sample, double lo, double hi,
-        RandomNumberGenerator &rng, vector<size_t> &counts) {
+static void bin_samples(const vector<double> &samples, double lo,
+        double hi, vector<size_t> &counts) {
     const double nbins = static_cast<double>(counts.size() - 2);
     const double w = (hi - lo)/nbins;
     double x;
     size_t i;
 
-    for (i = 0; i < NSAMPLES; i++) {
-        x = sample(rng);
+    for (i = 0; i < samples.size(); i++) {
+        x = samples[i];
         if (x < lo)
             counts[0]++;
         else if (hi <= x)
@@ -426,6 +427,16 @@ static void sample_bins(const sampler &sample, double lo, double hi,
     }
 }
 
+static void sample_bins(const sampler &sample, double lo, double hi,
+        RandomNumberGenerator &rng, vector<size_t> &counts) {
+    vector<double> samples(NSAMPLES);
+    size_t i;
+
+    for (i = 0; i < NSAMPLES; i++)
+        samples[i] = sample(rng);
+    bin_samples(samples, lo, hi, counts);
+}
+
 static void test_stdnormal_psi(RandomNumberGenerator &rng) {
     vector<double> probabilities(PSI_DF);
     const double lo = -5;
@@ -623,6 +634,116 @@ static void test_weakprng(void) {
     }
 }
 
+static void test_state_resume(RandomNumberGenerator &rng) {
+    // Draw past a partially consumed block so the buffer is saved too.
+    for (size_t i = 0; i < 7; i++)
+        rng.next();
+    const std::string state = rng.get_state();
+    vector<double> expected;
+    for (size_t i = 0; i < 100; i++) {
+        expected.push_back(rng.next());
+        expected.push_back(rng.stdnormal());
+    }
+
+    RandomNumberGenerator resumed(0);
+    resumed.set_state(state);
+    for (size_t i = 0; i < expected.size(); i += 2) {
+        assert(resumed.next() == expected[i]);
+        assert(resumed.stdnormal() == expected[i + 1]);
+    }
+    assert(resumed.get_state() == rng.get_state());
+}
+
+static void test_split(RandomNumberGenerator &rng) {
+    RandomNumberGenerator a = rng.split(3);
+    // Consuming the parent does not move its streams.
+    for (size_t i = 0; i < 100; i++)
+        rng.next();
+    RandomNumberGenerator b = rng.split(3);
+    RandomNumberGenerator c = rng.split(4);
+    RandomNumberGenerator grandchild = a.split(4);
+    assert(a.get_state() == b.get_state());
+    for (size_t i = 0; i < 100; i++) {
+        const double x = a.next();
+        assert(x == b.next());
+        assert(x != c.next());
+        assert(x != grandchild.next());
+    }
+
+    // A split stream is as uniform as the parent.
+    test_uniform01(c);
+}
+
+static void test_fill_uniform(RandomNumberGenerator &rng) {
+    vector<double> probabilities(PSI_DF);
+    size_t i;
+    unsigned trial, passes;
+
+    for (i = 0; i < probabilities.size(); i++)
+        probabilities[i] = 1/static_cast<double>(PSI_DF);
+
+    passes = 0;
+    for (trial = 0; trial < NTRIALS; trial++) {
+        vector<double> samples(NSAMPLES);
+        vector<size_t> counts(PSI_DF);
+
+        rng.fill_uniform(&samples[0], samples.size());
+        for (i = 0; i < samples.size(); i++) {
+            assert(0 < samples[i] && samples[i] < 1);
+            counts[static_cast<size_t>(floor(samples[i]*PSI_DF))]++;
+        }
+        passes += psi_test(counts, probabilities, NSAMPLES);
+        if (passes >= NPASSES_MIN)
+            break;
+    }
+    assert(passes >= NPASSES_MIN);
+}
+
+static void test_fill_stdnormal_psi(RandomNumberGenerator &rng) {
+    vector<double> probabilities(PSI_DF);
+    const double lo = -5;
+    const double hi = +5;
+    unsigned trial, passes;
+
+    cdf_bins(stdnormal_cdf, lo, hi, probabilities);
+
+    passes = 0;
+    for (trial = 0; trial < NTRIALS; trial++) {
+        // odd, to cover the unpaired last draw of each block
+        vector<double> samples(NSAMPLES - 1);
+        vector<size_t> counts(PSI_DF);
+
+        rng.fill_stdnormal(&samples[0], samples.size());
+        bin_samples(samples, lo, hi, counts);
+        passes += psi_test(counts, probabilities, samples.size());
+        if (passes >= NPASSES_MIN)
+            break;
+    }
+    assert(passes >= NPASSES_MIN);
+}
+
+static void test_fill_stdgamma_psi(RandomNumberGenerator &rng) {
+    vector<double> probabilities(PSI_DF);
+    const double lo = 0.1;
+    const double hi = 20;
+    unsigned trial, passes;
+
+    cdf_bins(stdgamma11_cdf, lo, hi, probabilities);
+
+    passes = 0;
+    for (trial = 0; trial < NTRIALS; trial++) {
+        vector<double> samples(NSAMPLES);
+        vector<size_t> counts(PSI_DF);
+
+        rng.fill_stdgamma(&samples[0], samples.size(), 11);
+        bin_samples(samples, lo, hi, counts);
+        passes += psi_test(counts, probabilities, NSAMPLES);
+        if (passes >= NPASSES_MIN)
+            break;
+    }
+    assert(passes >= NPASSES_MIN);
+}
+
 int main(int argc, char **argv) {
     std::cout << __FILE__ << "..." << std::endl;
 
@@ -639,6 +760,11 @@ int main(int argc, char **argv) {
     test_stdgamma_psi(rng);
     test_chisquare_psi(rng);
     test_student_t_psi(rng);
+    test_state_resume(rng);
+    test_split(rng);
+    test_fill_uniform(rng);
+    test_fill_stdnormal_psi(rng);
+    test_fill_stdgamma_psi(rng);
 
     std::cout << __FILE__ << " passed" << std::endl;
 }
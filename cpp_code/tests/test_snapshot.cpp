@@ -0,0 +1,174 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <cmath>
+#include <cstdio>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+#include <unistd.h>
+
+#include "Snapshot.h"
+#include "State.h"
+#include "test_support.h"
+
+using namespace std;
+
+static const char *SNAPSHOT_FILENAME = "test_snapshot.tmp";
+
+static void test_reader_writer() {
+    vector<int> ints;
+    ints.push_back(-3);
+    ints.push_back(1 << 30);
+    vector<double> doubles;
+    doubles.push_back(.5);
+    doubles.push_back(-INFINITY);
+    {
+        SnapshotWriter writer(SNAPSHOT_FILENAME);
+        writer.write_int(7);
+        writer.write_double(M_PI);
+        writer.write_ints(ints);
+        writer.write_doubles(doubles);
+        writer.write_doubles(vector<double>());
+        writer.write_string("dirichlet_alpha");
+        writer.close();
+    }
+    SnapshotReader reader(SNAPSHOT_FILENAME);
+    assert(reader.read_int() == 7);
+    assert(reader.read_double() == M_PI);
+    assert(reader.read_ints() == ints);
+    assert(reader.read_doubles() == doubles);
+    assert(reader.read_doubles().empty());
+    assert(reader.read_string() == "dirichlet_alpha");
+}
+
+static void test_state_round_trip() {
+    const int num_rows = 40;
+    vector<string> col_datatypes;
+    vector<int> multinomial_counts;
+    MatrixD data = mixed_data(num_rows, 5, col_datatypes, multinomial_counts);
+    vector<int> row_indices = create_sequence(num_rows);
+    vector<int> col_indices = create_sequence(3);
+    State s(data, col_datatypes, multinomial_counts, row_indices,
+        col_indices, FROM_THE_PRIOR, "", empty_vector_double,
+        empty_vector_double, empty_vector_double, empty_vector_double,
+        31, 3);
+    for (int step_idx = 0; step_idx < 3; step_idx++) {
+        s.transition(data);
+    }
+    s.save_snapshot(SNAPSHOT_FILENAME);
+    State loaded(data, SNAPSHOT_FILENAME);
+    assert(loaded.get_X_D() == s.get_X_D());
+    assert(loaded.get_column_partition_assignments()
+        == s.get_column_partition_assignments());
+    assert(loaded.get_column_hypers() == s.get_column_hypers());
+    assert(loaded.get_column_crp_alpha() == s.get_column_crp_alpha());
+    for (int view_idx = 0; view_idx < s.get_num_views(); view_idx++) {
+        assert(loaded.get_row_partition_model_hypers_i(view_idx)
+            == s.get_row_partition_model_hypers_i(view_idx));
+    }
+    // scores are recomputed from the saved suffstats: they match the
+    // original's clusters, not its running totals
+    for (int view_idx = 0; view_idx < s.get_num_views(); view_idx++) {
+        View &v = s.get_view(view_idx);
+        View &loaded_v = loaded.get_view(view_idx);
+        double data_score = 0;
+        for (int cluster_idx = 0; cluster_idx < v.get_num_clusters();
+            cluster_idx++) {
+            data_score += v.get_cluster(cluster_idx).calc_sum_marginal_logps();
+        }
+        assert(fabs(loaded_v.get_data_score() - data_score)
+            < 1e-8 * fabs(data_score));
+        assert(fabs(loaded_v.get_crp_score() - v.get_crp_score())
+            < 1e-8 * fabs(v.get_crp_score()));
+    }
+    // the generators resume where they were, so the chains stay in step
+    assert(loaded.get_rng_states() == s.get_rng_states());
+    for (int step_idx = 0; step_idx < 3; step_idx++) {
+        s.transition(data);
+        loaded.transition(data);
+        assert(loaded.get_X_D() == s.get_X_D());
+        assert(loaded.get_rng_states() == s.get_rng_states());
+    }
+}
+
+static void test_bad_snapshots() {
+    // a vector longer than the file, a negative length and a value past
+    // the end of the file all throw rather than allocate or read garbage
+    int32_t bad_sizes[] = {1 << 30, -1};
+    for (int i = 0; i < 2; i++) {
+        {
+            SnapshotWriter writer(SNAPSHOT_FILENAME);
+            writer.write_int(bad_sizes[i]);
+            writer.write_double(.5);
+            writer.close();
+        }
+        SnapshotReader reader(SNAPSHOT_FILENAME);
+        bool threw = false;
+        try {
+            reader.read_doubles();
+        } catch (const runtime_error &) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    {
+        SnapshotWriter writer(SNAPSHOT_FILENAME);
+        writer.write_int(7);
+        writer.close();
+    }
+    SnapshotReader reader(SNAPSHOT_FILENAME);
+    assert(reader.read_int() == 7);
+    bool threw = false;
+    try {
+        reader.read_double();
+    } catch (const runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+    // a state snapshot only loads on a table of its own shape
+    MatrixD data = indexed_data(4, 1);
+    vector<string> col_datatypes(1, CONTINUOUS_DATATYPE);
+    vector<int> multinomial_counts(1, 0);
+    State s(data, col_datatypes, multinomial_counts, create_sequence(4),
+        create_sequence(1));
+    s.save_snapshot(SNAPSHOT_FILENAME);
+    MatrixD other_data(3, 1);
+    threw = false;
+    try {
+        State loaded(other_data, SNAPSHOT_FILENAME);
+    } catch (const runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+    // and a truncated one doesn't load at all
+    int rc = truncate(SNAPSHOT_FILENAME, 64);
+    assert(rc == 0);
+    threw = false;
+    try {
+        State loaded(data, SNAPSHOT_FILENAME);
+    } catch (const runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+int main(int argc, char **argv) {
+    test_reader_writer();
+    test_state_round_trip();
+    test_bad_snapshots();
+    remove(SNAPSHOT_FILENAME);
+    return 0;
+}
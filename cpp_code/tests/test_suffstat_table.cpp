@@ -0,0 +1,195 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <cassert>
+#include <vector>
+
+#include "Cluster.h"
+#include "RandomNumberGenerator.h"
+#include "SuffstatTable.h"
+#include "constants.h"
+
+using namespace std;
+
+static void assert_matches(const SuffstatTable &table,
+    const vector<Cluster *> &clusters, const vector<CM_Hypers *> &hypers_v,
+    const vector<double> &vd) {
+    vector<double> data_logps;
+    table.calc_row_predictive_logps(vd, data_logps);
+    assert(data_logps.size() == clusters.size() + 1);
+    for (size_t i = 0; i < clusters.size(); i++) {
+        double expected = clusters[i]->calc_row_predictive_logp(vd);
+        assert(fabs(data_logps[i] - expected) < 1e-10);
+    }
+    Cluster empty_cluster(hypers_v);
+    double expected = empty_cluster.calc_row_predictive_logp(vd);
+    assert(fabs(data_logps.back() - expected) < 1e-10);
+    empty_cluster.delete_component_models();
+}
+
+static vector<double> random_row(RandomNumberGenerator &rng) {
+    vector<double> row;
+    row.push_back(3 * rng.stdnormal());
+    row.push_back(rng.nexti(4));
+    row.push_back(2 * M_PI * rng.next());
+    if (rng.nexti(5) == 0) {
+        row[rng.nexti(2)] = NAN;
+    }
+    return row;
+}
+
+int main(int argc, char **argv) {
+    RandomNumberGenerator rng;
+    CM_Hypers continuous_hypers, multinomial_hypers, cyclic_hypers;
+    continuous_hypers["r"] = 1.0;
+    continuous_hypers["nu"] = 2.0;
+    continuous_hypers["s"] = 1.5;
+    continuous_hypers["mu"] = 0.5;
+    multinomial_hypers["K"] = 4;
+    multinomial_hypers["dirichlet_alpha"] = 1.5;
+    cyclic_hypers["kappa"] = 1.0;
+    cyclic_hypers["a"] = 2.0;
+    cyclic_hypers["b"] = 1.0;
+    vector<CM_Hypers *> hypers_v;
+    hypers_v.push_back(&continuous_hypers);
+    hypers_v.push_back(&multinomial_hypers);
+    hypers_v.push_back(&cyclic_hypers);
+
+    SuffstatTable table;
+    table.insert_col(CONTINUOUS_DATATYPE, continuous_hypers);
+    table.insert_col(MULTINOMIAL_DATATYPE, multinomial_hypers);
+    table.insert_col(CYCLIC_DATATYPE, cyclic_hypers);
+    assert(table.get_num_cols() == 3);
+
+    vector<Cluster *> clusters;
+    vector<vector<double> > rows;
+    for (int cluster_idx = 0; cluster_idx < 3; cluster_idx++) {
+        clusters.push_back(new Cluster(hypers_v));
+        table.insert_cluster();
+    }
+    assert(table.get_num_clusters() == 3);
+    for (int row_idx = 0; row_idx < 30; row_idx++) {
+        vector<double> row = random_row(rng);
+        int cluster_idx = row_idx % 3;
+        clusters[cluster_idx]->insert_row(row, row_idx);
+        table.insert_row(cluster_idx, row);
+        rows.push_back(row);
+    }
+    for (int i = 0; i < 10; i++) {
+        assert_matches(table, clusters, hypers_v, random_row(rng));
+    }
+
+    // remove some rows
+    for (int row_idx = 0; row_idx < 30; row_idx += 4) {
+        int cluster_idx = row_idx % 3;
+        clusters[cluster_idx]->remove_row(rows[row_idx], row_idx);
+        table.remove_row(cluster_idx, rows[row_idx]);
+    }
+    assert_matches(table, clusters, hypers_v, random_row(rng));
+
+    // change hypers
+    continuous_hypers["s"] = 4.0;
+    cyclic_hypers["a"] = 0.5;
+    for (int cluster_idx = 0; cluster_idx < 3; cluster_idx++) {
+        clusters[cluster_idx]->incorporate_hyper_update(0);
+        clusters[cluster_idx]->incorporate_hyper_update(2);
+    }
+    table.incorporate_hyper_update(0);
+    table.incorporate_hyper_update(2);
+    assert_matches(table, clusters, hypers_v, random_row(rng));
+
+    // the cached empty cluster terms follow every hyper
+    multinomial_hypers["dirichlet_alpha"] = 0.25;
+    cyclic_hypers["kappa"] = 3.0;
+    cyclic_hypers["b"] = 4.0;
+    for (int cluster_idx = 0; cluster_idx < 3; cluster_idx++) {
+        clusters[cluster_idx]->incorporate_hyper_update(1);
+        clusters[cluster_idx]->incorporate_hyper_update(2);
+    }
+    table.incorporate_hyper_update(1);
+    table.incorporate_hyper_update(2);
+    for (int i = 0; i < 10; i++) {
+        assert_matches(table, clusters, hypers_v, random_row(rng));
+    }
+
+    // dirichlet_alpha conditionals match the ComponentModels exactly
+    vector<double> alpha_grid = log_linspace(.1, 10, 5);
+    LgammaTable lgamma_table;
+    for (int i = 0; i < 2; i++) {
+        vector<vector<double> > vec_vec;
+        for (size_t cluster_idx = 0; cluster_idx < clusters.size();
+            cluster_idx++) {
+            vec_vec.push_back(clusters[cluster_idx]->calc_hyper_conditionals(1,
+                    "dirichlet_alpha", alpha_grid));
+        }
+        assert(table.calc_dirichlet_alpha_conditionals(1, alpha_grid,
+                lgamma_table) == std_vector_add(vec_vec));
+    }
+
+    // the fused continuous hyper conditionals agree with the per-cluster
+    // ones up to the batched log
+    const char *continuous_hyper_names[] = {"r", "nu", "s", "mu"};
+    for (int i = 0; i < 4; i++) {
+        string hyper_name = continuous_hyper_names[i];
+        vector<double> grid = hyper_name == "mu" ? linspace(-3, 3, 7)
+            : log_linspace(.1, 10, 7);
+        vector<vector<double> > vec_vec;
+        for (size_t cluster_idx = 0; cluster_idx < clusters.size();
+            cluster_idx++) {
+            vec_vec.push_back(clusters[cluster_idx]->calc_hyper_conditionals(0,
+                    hyper_name, grid));
+        }
+        vector<double> expected = std_vector_add(vec_vec);
+        vector<double> logps = table.calc_continuous_hyper_conditionals(0,
+                get_hyper_id(hyper_name), grid);
+        assert(logps.size() == grid.size());
+        for (size_t grid_idx = 0; grid_idx < grid.size(); grid_idx++) {
+            assert(fabs(logps[grid_idx] - expected[grid_idx])
+                < 1e-10 * (1 + fabs(expected[grid_idx])));
+        }
+    }
+
+    // drop the middle cluster
+    table.remove_cluster(1);
+    clusters[1]->delete_component_models(false);
+    delete clusters[1];
+    clusters.erase(clusters.begin() + 1);
+    assert_matches(table, clusters, hypers_v, random_row(rng));
+
+    // drop the first column; the cyclic column takes its slot
+    table.remove_col(0);
+    for (size_t i = 0; i < clusters.size(); i++) {
+        clusters[i]->remove_col(0);
+    }
+    hypers_v[0] = hypers_v.back();
+    hypers_v.pop_back();
+    assert(table.get_num_cols() == 2);
+    for (int i = 0; i < 10; i++) {
+        vector<double> row = random_row(rng);
+        row[0] = row.back();
+        row.pop_back();
+        assert_matches(table, clusters, hypers_v, row);
+    }
+
+    for (size_t i = 0; i < clusters.size(); i++) {
+        clusters[i]->delete_component_models(false);
+        delete clusters[i];
+    }
+    return 0;
+}
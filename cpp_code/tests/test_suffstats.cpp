@@ -0,0 +1,106 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "ComponentModel.h"
+#include "ContinuousComponentModel.h"
+#include "CyclicComponentModel.h"
+#include "MultinomialComponentModel.h"
+#include "RandomNumberGenerator.h"
+#include "Suffstats.h"
+#include "constants.h"
+
+using namespace std;
+
+static bool is_close(double a, double b) {
+    return fabs(a - b) <= 1e-8 * (1 + fabs(a));
+}
+
+// Insert elements into a Suffstats and a ComponentModel side by side,
+// remove some again and check both agree on the marginal logp.
+static void check_against(ComponentModel &cm, const string &col_datatype,
+    const CM_Hypers &hypers, const vector<double> &elements) {
+    Suffstats suffstats(col_datatype, hypers);
+    assert(is_close(suffstats.calc_marginal_logp(),
+        cm.calc_marginal_logp()));
+    for (size_t i = 0; i < elements.size(); i++) {
+        suffstats.insert_element(elements[i]);
+        cm.insert_element(elements[i]);
+        assert(is_close(suffstats.calc_marginal_logp(),
+            cm.calc_marginal_logp()));
+    }
+    for (size_t i = 0; i < elements.size(); i += 2) {
+        suffstats.remove_element(elements[i]);
+        cm.remove_element(elements[i]);
+        assert(is_close(suffstats.calc_marginal_logp(),
+            cm.calc_marginal_logp()));
+    }
+}
+
+static void test_continuous(RandomNumberGenerator &rng) {
+    CM_Hypers hypers;
+    hypers["r"] = 1.5;
+    hypers["nu"] = 2.5;
+    hypers["s"] = 3.0;
+    hypers["mu"] = -1.0;
+    vector<double> elements;
+    for (int i = 0; i < 20; i++) {
+        elements.push_back(5 * rng.stdnormal());
+    }
+    elements.push_back(NAN);
+    ContinuousComponentModel cm(hypers);
+    check_against(cm, CONTINUOUS_DATATYPE, hypers, elements);
+}
+
+static void test_cyclic(RandomNumberGenerator &rng) {
+    CM_Hypers hypers;
+    hypers["kappa"] = 2.0;
+    hypers["a"] = 1.0;
+    hypers["b"] = M_PI;
+    vector<double> elements;
+    for (int i = 0; i < 20; i++) {
+        elements.push_back(2 * M_PI * rng.next());
+    }
+    CyclicComponentModel cm(hypers);
+    check_against(cm, CYCLIC_DATATYPE, hypers, elements);
+}
+
+static void test_multinomial(RandomNumberGenerator &rng) {
+    CM_Hypers hypers;
+    hypers["K"] = 5;
+    hypers["dirichlet_alpha"] = 0.7;
+    vector<double> elements;
+    for (int i = 0; i < 20; i++) {
+        elements.push_back(rng.nexti(5));
+    }
+    elements.push_back(NAN);
+    MultinomialComponentModel cm(hypers);
+    check_against(cm, MULTINOMIAL_DATATYPE, hypers, elements);
+}
+
+int main(int argc, char **argv) {
+    RandomNumberGenerator rng;
+    test_continuous(rng);
+    test_cyclic(rng);
+    test_multinomial(rng);
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#ifndef GUARD_test_support_h
+#define GUARD_test_support_h
+
+// Data and state factories and checks shared by the tests
+
+#include <cmath>
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "RandomNumberGenerator.h"
+#include "State.h"
+
+// data(row_idx, col_idx) == 10 * row_idx + col_idx, so every cell is
+// distinct and its position readable from its value
+inline MatrixD indexed_data(int num_rows, int num_cols) {
+    MatrixD data(num_rows, num_cols);
+    for (int row_idx = 0; row_idx < num_rows; row_idx++) {
+        for (int col_idx = 0; col_idx < num_cols; col_idx++) {
+            data(row_idx, col_idx) = 10 * row_idx + col_idx;
+        }
+    }
+    return data;
+}
+
+// two continuous columns of num_groups well separated groups, row_idx in
+// group row_idx % num_groups
+inline MatrixD grouped_data(int num_rows, int num_groups, int seed) {
+    RandomNumberGenerator rng(seed);
+    MatrixD data(num_rows, 2);
+    for (int row_idx = 0; row_idx < num_rows; row_idx++) {
+        double mean = 20 * (row_idx % num_groups);
+        data(row_idx, 0) = mean + rng.stdnormal();
+        data(row_idx, 1) = -mean + rng.stdnormal();
+    }
+    return data;
+}
+
+// a continuous column of two groups, a multinomial column of 3 labels and
+// a cyclic column, with their datatypes and counts appended to
+// col_datatypes and multinomial_counts
+inline MatrixD mixed_data(int num_rows, int seed,
+    std::vector<std::string> &col_datatypes,
+    std::vector<int> &multinomial_counts) {
+    RandomNumberGenerator rng(seed);
+    MatrixD data(num_rows, 3);
+    col_datatypes.push_back(CONTINUOUS_DATATYPE);
+    multinomial_counts.push_back(0);
+    col_datatypes.push_back(MULTINOMIAL_DATATYPE);
+    multinomial_counts.push_back(3);
+    col_datatypes.push_back(CYCLIC_DATATYPE);
+    multinomial_counts.push_back(0);
+    for (int row_idx = 0; row_idx < num_rows; row_idx++) {
+        data(row_idx, 0) = 4 * (row_idx % 2) + rng.stdnormal();
+        data(row_idx, 1) = rng.nexti(3);
+        data(row_idx, 2) = 2 * M_PI * rng.next();
+    }
+    return data;
+}
+
+// a State over continuous data with all columns in one view
+inline State *new_state(const MatrixD &data,
+    const std::string &row_initialization, int seed) {
+    int num_cols = data.size2();
+    std::vector<std::string> col_datatypes(num_cols, CONTINUOUS_DATATYPE);
+    std::vector<int> multinomial_counts(num_cols, 0);
+    std::vector<int> row_indices = create_sequence(data.size1());
+    std::vector<int> col_indices = create_sequence(num_cols);
+    return new State(data, col_datatypes, multinomial_counts, row_indices,
+        col_indices, TOGETHER, row_initialization, empty_vector_double,
+        empty_vector_double, empty_vector_double, empty_vector_double,
+        31, seed);
+}
+
+// the running scores agree with scores recomputed from the clusters
+inline void assert_scores_consistent(View &v) {
+    double data_score = 0;
+    for (int cluster_idx = 0; cluster_idx < v.get_num_clusters();
+        cluster_idx++) {
+        data_score += v.get_cluster(cluster_idx).calc_sum_marginal_logps();
+    }
+    assert(fabs(v.get_data_score() - data_score)
+        < 1e-8 * (1 + fabs(data_score)));
+    assert(fabs(v.get_crp_score() - v.calc_crp_marginal())
+        < 1e-8 * (1 + fabs(v.get_crp_score())));
+}
+
+#endif // GUARD_test_support_h
@@ -0,0 +1,59 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <cassert>
+#include <vector>
+
+#include "ThreadPool.h"
+
+using namespace std;
+
+class SquareTask : public ThreadPoolTask
+{
+public:
+    SquareTask(int num_tasks) : squares(num_tasks, -1) {}
+    void run(int task_idx)
+    {
+        assert(squares[task_idx] == -1);
+        squares[task_idx] = task_idx * task_idx;
+    }
+    vector<int> squares;
+};
+
+static void test_run(int num_threads) {
+    ThreadPool pool(num_threads);
+    assert(pool.get_num_threads() == num_threads);
+    // reuse the pool for several batches, including degenerate ones
+    int batch_sizes[] = {0, 1, 3, 17, 100};
+    for (int batch_idx = 0; batch_idx < 5; batch_idx++) {
+        int num_tasks = batch_sizes[batch_idx];
+        SquareTask task(num_tasks);
+        pool.run(task, num_tasks);
+        for (int task_idx = 0; task_idx < num_tasks; task_idx++) {
+            assert(task.squares[task_idx] == task_idx * task_idx);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    test_run(1);
+    test_run(2);
+    test_run(8);
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <cmath>
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "RandomNumberGenerator.h"
+#include "State.h"
+#include "test_support.h"
+
+using namespace std;
+
+// cluster labels numbered by first appearance
+static vector<int> relabel(const vector<int> &clustering) {
+    map<int, int> labels;
+    vector<int> relabeled;
+    for (size_t i = 0; i < clustering.size(); i++) {
+        if (labels.find(clustering[i]) == labels.end()) {
+            int label = labels.size();
+            labels[clustering[i]] = label;
+        }
+        relabeled.push_back(labels[clustering[i]]);
+    }
+    return relabeled;
+}
+
+// Three rows have five partitions.  Split-merge alone, with the hypers
+// and crp alpha held fixed, must visit them in proportion to exp(score).
+static void test_stationary_distribution() {
+    RandomNumberGenerator rng(20);
+    MatrixD data(3, 1);
+    data(0, 0) = -1;
+    data(1, 0) = 0.5;
+    data(2, 0) = 2;
+    State *p_s = new_state(data, TOGETHER, 7);
+    View &v = p_s->get_view(0);
+    const int num_steps = 40000;
+    map<vector<int>, int> visits;
+    map<vector<int>, double> scores;
+    for (int step_idx = 0; step_idx < num_steps; step_idx++) {
+        p_s->transition_row_partition_split_merge(data, 1);
+        vector<int> partition = relabel(v.get_canonical_clustering());
+        visits[partition]++;
+        scores[partition] = v.get_score();
+    }
+    assert(visits.size() == 5);
+    assert_scores_consistent(v);
+    double partition_function = 0;
+    map<vector<int>, double>::const_iterator it;
+    for (it = scores.begin(); it != scores.end(); ++it) {
+        partition_function += exp(it->second);
+    }
+    for (it = scores.begin(); it != scores.end(); ++it) {
+        double expected = exp(it->second) / partition_function;
+        double observed = visits[it->first] / (double) num_steps;
+        cout << it->first << " expected " << expected
+            << " observed " << observed << endl;
+        assert(fabs(observed - expected) < .02);
+    }
+    delete p_s;
+}
+
+// Well separated groups are found from one cluster, and one group is
+// gathered up from singletons.
+static void test_split_and_merge() {
+    const int num_groups = 3;
+    const int num_rows = 60;
+    MatrixD data = grouped_data(num_rows, num_groups, 21);
+    State *p_s = new_state(data, TOGETHER, 8);
+    View &v = p_s->get_view(0);
+    assert(v.get_num_clusters() == 1);
+    // the hypers drawn from the prior may favor wide clusters, so let
+    // them adapt too
+    vector<int> all_cols;
+    for (int step_idx = 0; step_idx < 20; step_idx++) {
+        p_s->transition_row_partition_split_merge(data, 10);
+        p_s->transition_column_hyperparameters(all_cols);
+    }
+    assert_scores_consistent(v);
+    assert(v.get_num_clusters() >= num_groups);
+    delete p_s;
+
+    MatrixD one_group = grouped_data(num_rows, 1, 22);
+    p_s = new_state(one_group, APART, 9);
+    View &w = p_s->get_view(0);
+    assert(w.get_num_clusters() == num_rows);
+    // a small crp alpha, so the singletons are far from the posterior
+    w.set_crp_alpha(1);
+    for (int step_idx = 0; step_idx < 20; step_idx++) {
+        p_s->transition_row_partition_split_merge(one_group, 10);
+    }
+    assert_scores_consistent(w);
+    assert(w.get_num_clusters() < num_rows / 4);
+    delete p_s;
+}
+
+int main(int argc, char **argv) {
+    cout << __FILE__ << "..." << endl;
+    test_stationary_distribution();
+    test_split_and_merge();
+    cout << __FILE__ << " passed" << endl;
+    return 0;
+}
@@ -0,0 +1,94 @@
+/*
+*   Copyright (c) 2010-2016, MIT Probabilistic Computing Project
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+*/
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include "RandomNumberGenerator.h"
+#include "State.h"
+#include "test_support.h"
+
+using namespace std;
+
+// The sweep order is the documented Fisher-Yates permutation of the rows
+// in ascending order, driven by the view's rng.
+static void test_shuffle_row_indices() {
+    const int num_rows = 50;
+    MatrixD data = grouped_data(num_rows, 3, 32);
+    State *p_s = new_state(data, FROM_THE_PRIOR, 12);
+    View &v = p_s->get_view(0);
+    for (int sweep_idx = 0; sweep_idx < 3; sweep_idx++) {
+        RandomNumberGenerator rng;
+        rng.set_state(v.get_rng_state());
+        vector<int> expected = create_sequence(num_rows);
+        for (int i = num_rows - 1; i > 0; i--) {
+            int j = rng.nexti(i + 1);
+            std::swap(expected[i], expected[j]);
+        }
+        vector<int> shuffled = v.shuffle_row_indices();
+        assert(shuffled == expected);
+        assert(v.get_rng_state() == rng.get_state());
+    }
+    delete p_s;
+}
+
+// An empty subset is a no-op and a subset of every row is a full sweep.
+static void test_subsample_bounds() {
+    MatrixD data = grouped_data(30, 3, 30);
+    State *p_s = new_state(data, FROM_THE_PRIOR, 10);
+    State *p_t = new_state(data, FROM_THE_PRIOR, 10);
+    View &v = p_s->get_view(0);
+    View &w = p_t->get_view(0);
+    vector<int> before = v.get_canonical_clustering();
+    assert(p_s->transition_row_partition_subsample(data, 0) == 0);
+    assert(v.get_canonical_clustering() == before);
+    for (int step_idx = 0; step_idx < 5; step_idx++) {
+        v.transition_zs_subsample(data.size1() + step_idx);
+        w.transition_zs();
+        assert(v.get_canonical_clustering() == w.get_canonical_clustering());
+        assert(v.get_score() == w.get_score());
+    }
+    delete p_s;
+    delete p_t;
+}
+
+// Partial sweeps of a tenth of the rows still gather up well separated
+// groups from singletons, as every row is eventually visited.
+static void test_partial_sweeps() {
+    const int num_groups = 3;
+    const int num_rows = 60;
+    MatrixD data = grouped_data(num_rows, num_groups, 31);
+    State *p_s = new_state(data, APART, 11);
+    View &v = p_s->get_view(0);
+    assert(v.get_num_clusters() == num_rows);
+    for (int step_idx = 0; step_idx < 100; step_idx++) {
+        p_s->transition_row_partition_subsample(data, num_rows / 10);
+    }
+    assert_scores_consistent(v);
+    assert(v.get_num_clusters() < num_rows / 4);
+    delete p_s;
+}
+
+int main(int argc, char **argv) {
+    cout << __FILE__ << "..." << endl;
+    test_shuffle_row_indices();
+    test_subsample_bounds();
+    test_partial_sweeps();
+    cout << __FILE__ << " passed" << endl;
+    return 0;
+}
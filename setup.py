@@ -152,6 +152,8 @@ ContinuousComponentModel_pyx_sources = ['ContinuousComponentModel.pyx']
 ContinuousComponentModel_cpp_sources = [
     'ComponentModel.cpp',
     'ContinuousComponentModel.cpp',
+    'Hypers.cpp',
+    'LgammaTable.cpp',
     'RandomNumberGenerator.cpp',
     'numerics.cpp',
     'utils.cpp',
@@ -165,6 +167,8 @@ ContinuousComponentModel_sources = generate_sources([
 MultinomialComponentModel_pyx_sources = ['MultinomialComponentModel.pyx']
 MultinomialComponentModel_cpp_sources = [
     'ComponentModel.cpp',
+    'Hypers.cpp',
+    'LgammaTable.cpp',
     'MultinomialComponentModel.cpp',
     'RandomNumberGenerator.cpp',
     'numerics.cpp',
@@ -180,6 +184,8 @@ CyclicComponentModel_pyx_sources = ['CyclicComponentModel.pyx']
 CyclicComponentModel_cpp_sources = [
     'ComponentModel.cpp',
     'CyclicComponentModel.cpp',
+    'Hypers.cpp',
+    'LgammaTable.cpp',
     'RandomNumberGenerator.cpp',
     'numerics.cpp',
     'utils.cpp',
@@ -192,14 +198,22 @@ CyclicComponentModel_sources = generate_sources([
 #
 State_pyx_sources = ['State.pyx']
 State_cpp_sources = [
+    'ChainEnsemble.cpp',
     'Cluster.cpp',
     'ComponentModel.cpp',
     'ContinuousComponentModel.cpp',
     'CyclicComponentModel.cpp',
+    'DataStore.cpp',
     'DateTime.cpp',
+    'Hypers.cpp',
+    'LgammaTable.cpp',
     'MultinomialComponentModel.cpp',
     'RandomNumberGenerator.cpp',
+    'Snapshot.cpp',
     'State.cpp',
+    'SuffstatTable.cpp',
+    'Suffstats.cpp',
+    'ThreadPool.cpp',
     'View.cpp',
     'numerics.cpp',
     'utils.cpp',
@@ -214,28 +228,29 @@ State_sources = generate_sources([
 # create exts
 ContinuousComponentModel_ext = Extension(
     'crosscat.cython_code.ContinuousComponentModel',
-    extra_compile_args = [],
+    extra_compile_args = ['-ffp-contract=off'],
     sources=ContinuousComponentModel_sources,
     include_dirs=include_dirs,
     language='c++',
 )
 MultinomialComponentModel_ext = Extension(
     'crosscat.cython_code.MultinomialComponentModel',
-    extra_compile_args = [],
+    extra_compile_args = ['-ffp-contract=off'],
     sources=MultinomialComponentModel_sources,
     include_dirs=include_dirs,
     language='c++',
 )
 CyclicComponentModel_ext = Extension(
     'crosscat.cython_code.CyclicComponentModel',
-    extra_compile_args = [],
+    extra_compile_args = ['-ffp-contract=off'],
     sources=CyclicComponentModel_sources,
     include_dirs=include_dirs,
     language='c++',
 )
 State_ext = Extension(
     'crosscat.cython_code.State',
-    extra_compile_args = [],
+    extra_compile_args = ['-pthread', '-ffp-contract=off'],
+    extra_link_args = ['-pthread'],
     sources=State_sources,
     include_dirs=include_dirs,
     language='c++',
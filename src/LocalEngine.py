@@ -204,8 +204,12 @@ class LocalEngine(EngineTemplate.EngineTemplate):
         :type n_steps: int
         :param c: the (global) column indices to run MCMC transition kernels on
         :type c: list of ints
-        :param r: the (global) row indices to run MCMC transition kernels on
-        :type r: list of ints
+        :param r: the (global) row indices to run MCMC transition kernels on,
+            or a number for partial row sweeps over a random subset of rows
+            each step: an int in [1, number of rows] is a count of rows and
+            a float in (0, 1] a fraction of them, so r=1 is one row but
+            r=1.0 every row; out of range raises ValueError
+        :type r: list of ints, float or int
         :param max_iterations: the maximum number of times ot run each MCMC
             transition kernel. Applicable only if max_time != -1.
         :type max_iterations: int
@@ -50,6 +50,7 @@ cdef extern from "MultinomialComponentModel.h":
         cpp_string to_string()
         double get_draw(int seed)
         double get_draw_constrained(int seed, vector[double] constraints)
+        vector[double] get_draws(int seed, int num_draws)
         double get_predictive_probability(double element, vector[double] constraints)
         void get_suffstats(int count_out, cpp_map[cpp_string, double] &counts)
         double insert_element(double element)
@@ -80,6 +81,8 @@ cdef class p_MultinomialComponentModel:
         return self.thisptr.get_draw(seed)
     def get_draw_constrained(self, seed, constraints):
         return self.thisptr.get_draw_constrained(seed, constraints)
+    def get_draws(self, seed, num_draws):
+        return self.thisptr.get_draws(seed, num_draws)
     def get_suffstats(self):
         cdef int count_out
         count_out = 0
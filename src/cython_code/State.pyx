@@ -28,6 +28,8 @@ from cython.operator import dereference
 cimport numpy as np
 
 import collections
+import math
+import numbers
 import numpy
 import six
 
@@ -40,11 +42,6 @@ cdef c_map[int, c_set[int]] empty_map_of_int_set():
     return retval
 
 
-cdef double set_double(double& to_set, double value):
-    (&to_set)[0] = value	# (&...)[0] works around Cython >=0.18 bug.
-    return to_set
-
-
 cdef vector[int] convert_int_vector_to_cpp(python_vector):
     cdef vector[int] ret_vec
     for value in python_vector:
@@ -67,18 +64,36 @@ cdef extern from "Matrix.h":
         size_t size2()
         double& operator()(size_t i, size_t j)
     matrix[double] *new_matrix "new matrix<double>" (size_t i, size_t j)
+    matrix[double] *new_matrix_view "new matrix<double>" (
+        double *data, size_t i, size_t j, bool column_major)
     void del_matrix "delete" (matrix *m)
 
 
-cdef matrix[double]* convert_data_to_cpp(np.ndarray[np.float64_t, ndim=2] data):
-    cdef int num_rows = data.shape[0]
-    cdef int num_cols = data.shape[1]
-    dataptr = new_matrix(num_rows, num_cols)
-    cdef int i,j
-    for i from 0 <= i < num_rows:
-        for j from 0 <= j < num_cols:
-            set_double(dereference(dataptr)(i,j), data[i,j])
-    return dataptr
+def as_contiguous_data(T):
+    """A read-only float64 ndarray view of T that wrap_data_in_cpp can use,
+    copying only if T isn't a C- or Fortran-contiguous float64 array
+    already.  Otherwise the view shares T's memory, so later changes to T
+    show through it.  A State reads a Fortran-ordered array in place but
+    copies a C-ordered one once into its column-major DataStore; pass
+    numpy.asfortranarray(T) to avoid that copy."""
+    T_array = numpy.asarray(T, dtype=numpy.float64)
+    if not (T_array.flags.c_contiguous or T_array.flags.f_contiguous):
+        T_array = numpy.ascontiguousarray(T_array)
+    # a view, so that T itself stays writeable
+    T_array = T_array.view()
+    T_array.flags.writeable = False
+    return T_array
+
+
+cdef matrix[double]* wrap_data_in_cpp(np.ndarray data):
+    # A view of data's buffer, not a copy: the caller keeps data alive for
+    # as long as the matrix.  data is untyped so that a read-only array
+    # from as_contiguous_data is accepted.
+    assert data.dtype == numpy.float64 and data.ndim == 2
+    assert data.flags.c_contiguous or data.flags.f_contiguous
+    cdef bool column_major = not data.flags.c_contiguous
+    return new_matrix_view(
+        <double *> data.data, data.shape[0], data.shape[1], column_major)
 
 
 cdef extern from "State.h":
@@ -93,12 +108,17 @@ cdef extern from "State.h":
         double transition_row_partition_hyperparameters(vector[int] which_cols)
         double transition_row_partition_assignments(
             matrix[double] data, vector[int] which_rows)
+        double transition_row_partition_subsample(
+            matrix[double] data, int num_rows)
+        double transition_row_partition_split_merge(
+            matrix[double] data, int num_proposals)
         double transition_views(matrix[double] data)
         double transition_view_i(int i, matrix[double] data)
         double transition_views_row_partition_hyper()
         double transition_views_col_hypers()
         double transition_views_zs(matrix[double] data)
         double calc_row_predictive_logp(vector[double] in_vd)
+        void set_num_threads(int num_threads)
 
         # Getters.
         double get_column_crp_alpha()
@@ -107,6 +127,7 @@ cdef extern from "State.h":
         double get_marginal_logp()
         vector[double] get_draw(int row_idx, int random_seed)
         int get_num_views()
+        int get_num_threads()
         c_map[int, vector[int]] get_column_groups()
         string to_string(string join_str, bool top_level)
         double draw_rand_u()
@@ -126,7 +147,10 @@ cdef extern from "State.h":
             int view_idx)
 
         vector[vector[int]] get_X_D()
+        vector[string] get_rng_states()
         void SaveResult()
+        void save_snapshot(string filename) except +
+        void set_rng_states(vector[string] rng_states)
 
     State *new_State "new State" (
         matrix[double] &data,
@@ -167,9 +191,38 @@ cdef extern from "State.h":
         int CT_KERNEL
     )
 
+    State *new_State_from_snapshot "new State" (
+        matrix[double] &data,
+        string snapshot_filename
+    ) except +
+
     void del_State "delete" (State *s)
 
 
+cdef extern from "ChainEnsemble.h":
+    cdef cppclass ChainEnsemble:
+        int get_num_chains()
+        int get_num_threads()
+        State& get_chain(int chain_idx)
+        void set_num_threads(int num_threads)
+        vector[double] transition(matrix[double] &data, int n_steps) nogil
+
+    ChainEnsemble *new_ChainEnsemble "new ChainEnsemble" (
+        matrix[double] &data,
+        vector[string] global_col_datatypes,
+        vector[int] global_col_multinomial_counts,
+        vector[int] global_row_indices,
+        vector[int] global_col_indices,
+        vector[int] SEEDS,
+        string col_initialization,
+        string row_initialization,
+        int N_GRID,
+        int CT_KERNEL
+    )
+
+    void del_ChainEnsemble "delete" (ChainEnsemble *e)
+
+
 def extract_column_types_counts(M_c):
     column_types = [
         column_metadata['modeltype']
@@ -200,6 +253,12 @@ transition_name_to_method_name_and_args = dict(
         ('transition_row_partition_assignments', ['r']),
      )
 
+# run only when named in which_transitions
+optional_transition_name_to_method_name_and_args = dict(
+     row_partition_split_merge=
+        ('transition_row_partition_split_merge', []),
+     )
+
 def get_all_transitions_permuted(seed):
      which_transitions = transition_name_to_method_name_and_args.keys()
      random_state = numpy.random.RandomState(seed)
@@ -208,6 +267,17 @@ def get_all_transitions_permuted(seed):
 
 
 cdef class p_State:
+    """A CrossCat state over the data T.
+
+    T is borrowed rather than copied when it is already a C- or
+    Fortran-contiguous float64 array: the state keeps a read-only view
+    of it, and the C++ DataStore reads a Fortran-ordered T in place.  The
+    caller must not modify T while the state is alive, or the state's
+    data changes silently.  Pass T.copy() to decouple them.
+
+    snapshot names a file written by save_snapshot on the same T; one
+    that can't be read, is corrupt or is of another shape raises
+    RuntimeError."""
 
     cdef State *thisptr
     cdef matrix[double] *dataptr
@@ -216,27 +286,41 @@ cdef class p_State:
     cdef vector[string] column_types
     cdef vector[int] event_counts
     cdef np.ndarray T_array
+    # the p_ChainEnsemble this state is a chain of, or None if it owns
+    # thisptr and dataptr
+    cdef object owner
     cpdef M_c
 
     def __cinit__(
             self, M_c, T, X_L=None, X_D=None,
             initialization='from_the_prior', row_initialization=-1,
             ROW_CRP_ALPHA_GRID=(), COLUMN_CRP_ALPHA_GRID=(),
-            S_GRID=(), MU_GRID=(), N_GRID=31, SEED=0, CT_KERNEL=0
+            S_GRID=(), MU_GRID=(), N_GRID=31, SEED=0, CT_KERNEL=0,
+            snapshot=None
         ):
+        if T is None:
+            # filled in by p_ChainEnsemble.get_chain
+            return
         column_types, event_counts = extract_column_types_counts(M_c)
         global_row_indices = range(len(T))
         global_col_indices = range(len(T[0]))
 
-        # FIXME: keeping TWO copies of the data here
-        self.T_array = numpy.array(T)
-        self.dataptr = convert_data_to_cpp(self.T_array)
+        # dataptr, and the State's DataStore if T_array is Fortran-ordered,
+        # read T_array in place, so T_array lives as long as the State
+        self.T_array = as_contiguous_data(T)
+        self.dataptr = wrap_data_in_cpp(self.T_array)
         self.column_types = convert_string_vector_to_cpp(column_types)
         self.event_counts = convert_int_vector_to_cpp(event_counts)
         self.gri = convert_int_vector_to_cpp(global_row_indices)
         self.gci = convert_int_vector_to_cpp(global_col_indices)
         self.M_c = M_c
 
+        if snapshot is not None:
+            # see save_snapshot
+            self.thisptr = new_State_from_snapshot(
+                dereference(self.dataptr), snapshot)
+            return
+
         must_initialize = X_L is None
         if must_initialize:
             col_initialization = initialization
@@ -289,8 +373,9 @@ cdef class p_State:
             )
 
     def __dealloc__(self):
-        del_matrix(self.dataptr)
-        del_State(self.thisptr)
+        if self.owner is None:
+            del_matrix(self.dataptr)
+            del_State(self.thisptr)
 
     def __repr__(self):
         print_tuple = (
@@ -316,6 +401,8 @@ cdef class p_State:
         return self.thisptr.get_marginal_logp()
     def get_num_views(self):
         return self.thisptr.get_num_views()
+    def get_num_threads(self):
+        return self.thisptr.get_num_threads()
     def calc_row_predictive_logp(self, in_vd):
         return self.thisptr.calc_row_predictive_logp(in_vd)
     def get_draw(self, row_idx, random_seed):
@@ -443,7 +530,9 @@ cdef class p_State:
 
                     method_name_and_args = \
                         transition_name_to_method_name_and_args.get(
-                            which_transition)
+                            which_transition,
+                            optional_transition_name_to_method_name_and_args
+                                .get(which_transition))
 
                     if method_name_and_args is not None:
                         method_name, args_list = method_name_and_args
@@ -482,8 +571,38 @@ cdef class p_State:
     def transition_row_partition_hyperparameters(self, c=()):
         return self.thisptr.transition_row_partition_hyperparameters(c)
     def transition_row_partition_assignments(self, r=()):
+        """r is a list of row indices to transition in order, empty for a
+        full sweep, or a number for a partial sweep over a random subset
+        of rows drawn by each view.  The type of the number decides its
+        meaning: an int is a count of rows, in [1, number of rows], and a
+        float is a fraction of the rows, in (0, 1], rounded up to a count.
+        So r=1 transitions one row but r=1.0 all of them.  A number out of
+        range raises ValueError."""
+        total_rows = self.dataptr.size1()
+        if isinstance(r, numbers.Integral):
+            if not 1 <= r <= total_rows:
+                raise ValueError('row count r=%d not in [1, %d]'
+                    % (r, total_rows))
+            return self.thisptr.transition_row_partition_subsample(
+                dereference(self.dataptr), r)
+        if isinstance(r, numbers.Real):
+            if not 0 < r <= 1:
+                raise ValueError('row fraction r=%r not in (0, 1]' % (r,))
+            num_rows = int(math.ceil(r * total_rows))
+            return self.thisptr.transition_row_partition_subsample(
+                dereference(self.dataptr), num_rows)
         return self.thisptr.transition_row_partition_assignments(
             dereference(self.dataptr), r)
+    def transition_row_partition_split_merge(self, num_proposals=10):
+        """Sequentially allocated split-merge moves, num_proposals per
+        view.  Each moves whole clusters, so it complements the row
+        Gibbs of row_partition_assignments."""
+        return self.thisptr.transition_row_partition_split_merge(
+            dereference(self.dataptr), num_proposals)
+    def set_num_threads(self, num_threads):
+        """Transition views on num_threads threads.  The chain for a given
+        SEED does not depend on num_threads."""
+        self.thisptr.set_num_threads(num_threads)
     def transition_views(self):
         return self.thisptr.transition_views(dereference(self.dataptr))
     def transition_view_i(self, i):
@@ -533,6 +652,23 @@ cdef class p_State:
         sparsify_X_L(self.M_c, X_L)
         return X_L
 
+    def save_snapshot(self, filename):
+        """Write the latent state to filename in the C++ binary snapshot
+        format.  p_State(M_c, T, snapshot=filename) loads it back on the
+        same T without going through X_L and X_D, with the generators
+        resuming where they were.  Raises RuntimeError if the file can't
+        be written."""
+        self.thisptr.save_snapshot(filename)
+
+    def get_rng_states(self):
+        """Opaque generator states of the state and of each view, in view
+        order.  Passing them back to set_rng_states replays the same
+        transitions bit for bit."""
+        return self.thisptr.get_rng_states()
+
+    def set_rng_states(self, rng_states):
+        self.thisptr.set_rng_states(rng_states)
+
     def save(self, filename, dir='', **kwargs):
         save_dict = dict(
             X_L=self.get_X_L(),
@@ -542,6 +678,90 @@ cdef class p_State:
         fu.pickle(save_dict, filename, dir=dir)
 
 
+cdef class p_ChainEnsemble:
+    """Several chains over one shared copy of the data, transitioned in
+    parallel in C++.  Memory grows with the number of chains only for the
+    latent state.  T is borrowed as by p_State, so the caller must not
+    modify it while the ensemble is alive."""
+
+    cdef ChainEnsemble *thisptr
+    cdef matrix[double] *dataptr
+    cdef np.ndarray T_array
+    cpdef M_c
+
+    def __cinit__(
+            self, M_c, T, SEEDS,
+            initialization='from_the_prior', row_initialization=-1,
+            N_GRID=31, CT_KERNEL=0, num_threads=1
+        ):
+        column_types, event_counts = extract_column_types_counts(M_c)
+        global_row_indices = range(len(T))
+        global_col_indices = range(len(T[0]))
+        if row_initialization == -1:
+            row_initialization = initialization
+        self.M_c = M_c
+
+        # all chains share one DataStore, which reads T_array in place if
+        # it is Fortran-ordered and copies it once otherwise; as for
+        # p_State, T_array and dataptr live as long as the ensemble
+        self.T_array = as_contiguous_data(T)
+        self.dataptr = wrap_data_in_cpp(self.T_array)
+        self.thisptr = new_ChainEnsemble(
+            dereference(self.dataptr),
+            convert_string_vector_to_cpp(column_types),
+            convert_int_vector_to_cpp(event_counts),
+            convert_int_vector_to_cpp(global_row_indices),
+            convert_int_vector_to_cpp(global_col_indices),
+            convert_int_vector_to_cpp(SEEDS),
+            initialization,
+            row_initialization,
+            N_GRID, CT_KERNEL
+        )
+        self.thisptr.set_num_threads(num_threads)
+
+    def __dealloc__(self):
+        del_ChainEnsemble(self.thisptr)
+        del_matrix(self.dataptr)
+
+    def get_num_chains(self):
+        return self.thisptr.get_num_chains()
+    def get_num_threads(self):
+        return self.thisptr.get_num_threads()
+    def set_num_threads(self, num_threads):
+        """Transition chains on num_threads threads.  Each chain for a given
+        seed does not depend on num_threads."""
+        self.thisptr.set_num_threads(num_threads)
+
+    def get_chain(self, chain_idx):
+        """The p_State of chain chain_idx.  It is only valid while the
+        ensemble is, which it keeps alive."""
+        cdef p_State chain
+        if not 0 <= chain_idx < self.get_num_chains():
+            raise IndexError('chain_idx out of range: %r' % chain_idx)
+        chain = p_State.__new__(p_State, self.M_c, None)
+        chain.thisptr = &self.thisptr.get_chain(chain_idx)
+        chain.dataptr = self.dataptr
+        chain.M_c = self.M_c
+        chain.owner = self
+        return chain
+
+    def analyze(self, n_steps=1):
+        """Run n_steps of the C++ State::transition sweep on every chain,
+        without holding the GIL.  Returns the list of each chain's X_L and
+        the list of each chain's X_D."""
+        cdef int c_n_steps = n_steps
+        cdef matrix[double] *dataptr = self.dataptr
+        with nogil:
+            self.thisptr.transition(dereference(dataptr), c_n_steps)
+        chains = [
+            self.get_chain(chain_idx)
+            for chain_idx in range(self.get_num_chains())
+        ]
+        X_L_list = [chain.get_X_L() for chain in chains]
+        X_D_list = [chain.get_X_D() for chain in chains]
+        return X_L_list, X_D_list
+
+
 def indicator_list_to_list_of_list(indicator_list):
     list_of_list = []
     num_clusters = max(indicator_list) + 1